@@ -0,0 +1,819 @@
+//
+//  infyJSON lib
+//
+
+#include "Binary.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+namespace JSON {
+
+	namespace {
+
+		using namespace _binary;
+
+		constexpr char magic[4] = { 'I', 'J', 'B', '2' };
+		constexpr size_t headerSize = sizeof(magic) + sizeof(uint32_t);
+		constexpr size_t npos = static_cast<size_t>(-1);
+
+		//unsigned integer of T's size, so bytes are shifted in and out of the right end on any host
+		template<typename T>
+		using Bits = std::conditional_t<sizeof(T) == 1, uint8_t, std::conditional_t<sizeof(T) == 2, uint16_t,
+			std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>>>;
+
+		template<typename T>
+		void putLE(std::string& out, T value) {
+			Bits<T> bits;
+			std::memcpy(&bits, &value, sizeof(T));
+			for (size_t i = 0; i < sizeof(T); ++i) {
+				out += static_cast<char>((bits >> (8 * i)) & 0xFF);
+			}
+		}
+
+		template<typename T>
+		T getLE(const char* p) {
+			Bits<T> bits = 0;
+			for (size_t i = 0; i < sizeof(T); ++i) {
+				bits |= static_cast<Bits<T>>(static_cast<Bits<T>>(static_cast<unsigned char>(p[i])) << (8 * i));
+			}
+			T value;
+			std::memcpy(&value, &bits, sizeof(T));
+			return value;
+		}
+
+		template<typename T>
+		void putBE(std::string& out, T value) {
+			Bits<T> bits;
+			std::memcpy(&bits, &value, sizeof(T));
+			for (size_t i = sizeof(T); i > 0; --i) {
+				out += static_cast<char>((bits >> (8 * (i - 1))) & 0xFF);
+			}
+		}
+
+		//unsigned little-endian field of 1, 2 or 4 bytes
+		uint32_t getWidth(const char* p, size_t width) {
+			switch (width) {
+			case 1: return getLE<uint8_t>(p);
+			case 2: return getLE<uint16_t>(p);
+			default: return getLE<uint32_t>(p);
+			}
+		}
+
+		Kind kindOf(uint8_t tag) {
+			if (tag < FIXOBJECT_TAG || tag >= NEGATIVE_FIXINT_TAG) return INT_KIND;
+			if (tag < FIXARRAY_TAG) return OBJECT_KIND;
+			if (tag < FIXREF_TAG) return ARRAY_KIND;
+			if (tag < NULL_TAG) return STRING_KIND;
+			switch (tag) {
+			case NULL_TAG:
+				return NULL_KIND;
+			case FALSE_TAG:
+			case TRUE_TAG:
+				return BOOL_KIND;
+			case FLOAT_TAG:
+			case DOUBLE_TAG:
+				return DOUBLE_KIND;
+			case INT8_TAG:
+			case INT16_TAG:
+			case INT32_TAG:
+			case INT64_TAG:
+				return INT_KIND;
+			case REF8_TAG:
+			case REF16_TAG:
+			case REF32_TAG:
+			case STR8_TAG:
+			case STR16_TAG:
+			case STR32_TAG:
+				return STRING_KIND;
+			case ARRAY16_TAG:
+			case ARRAY32_TAG:
+				return ARRAY_KIND;
+			case OBJECT16_TAG:
+			case OBJECT32_TAG:
+				return OBJECT_KIND;
+			default:
+				return INVALID_KIND;
+			}
+		}
+
+		//decoded node header
+		struct Node {
+			uint8_t tag;
+			Kind kind;
+			size_t payload; //offset of number bytes, inline string bytes or first entry
+			size_t end; //offset right after the node
+			uint32_t count; //entries of container, table index of referenced string or length of inline string
+		};
+
+		//every offset in the node is checked against data bounds, entries of containers aren't looked at
+		bool decode(std::string_view data, size_t pos, Node& node) {
+			if (pos >= data.size()) return false;
+			const char* p = data.data() + pos;
+			size_t left = data.size() - pos - 1;
+			node.tag = static_cast<uint8_t>(*p);
+			node.kind = kindOf(node.tag);
+			node.payload = pos + 1;
+			node.count = 0;
+			size_t width = 0;
+			size_t body = 0;
+			switch (node.kind) {
+			case INT_KIND:
+				if (node.tag >= INT8_TAG && node.tag <= INT64_TAG) {
+					width = size_t{ 1 } << (node.tag - INT8_TAG);
+				}
+				break;
+			case DOUBLE_KIND:
+				width = node.tag == FLOAT_TAG ? sizeof(float) : sizeof(double);
+				break;
+			case STRING_KIND:
+				if (node.tag < NULL_TAG) {
+					node.count = node.tag - FIXREF_TAG;
+				} else if (node.tag <= REF32_TAG) {
+					width = size_t{ 1 } << (node.tag - REF8_TAG);
+					if (left < width) return false;
+					node.count = getWidth(p + 1, width);
+				} else {
+					size_t lengthWidth = size_t{ 1 } << (node.tag - STR8_TAG);
+					if (left < lengthWidth) return false;
+					node.count = getWidth(p + 1, lengthWidth);
+					node.payload += lengthWidth;
+					left -= lengthWidth;
+					width = node.count;
+				}
+				break;
+			case ARRAY_KIND:
+			case OBJECT_KIND:
+				if (node.tag < FIXREF_TAG) {
+					if (left < 1) return false;
+					node.count = node.tag & 0x0F;
+					body = getLE<uint8_t>(p + 1);
+					node.payload += 1;
+					left -= 1;
+				} else {
+					size_t fieldWidth = node.tag == ARRAY16_TAG || node.tag == OBJECT16_TAG ? 2 : 4;
+					if (left < 2 * fieldWidth) return false;
+					node.count = getWidth(p + 1, fieldWidth);
+					body = getWidth(p + 1 + fieldWidth, fieldWidth);
+					node.payload += 2 * fieldWidth;
+					left -= 2 * fieldWidth;
+				}
+				//every entry takes at least one byte per node
+				if (static_cast<uint64_t>(node.count) * (node.kind == OBJECT_KIND ? 2 : 1) > body) return false;
+				width = body;
+				break;
+			case INVALID_KIND:
+				return false;
+			default:
+				break;
+			}
+			if (left < width) return false;
+			node.end = node.payload + width;
+			return true;
+		}
+
+		int64_t intAt(const char* data, const Node& node) {
+			const char* p = data + node.payload;
+			switch (node.tag) {
+			case INT8_TAG: return getLE<int8_t>(p);
+			case INT16_TAG: return getLE<int16_t>(p);
+			case INT32_TAG: return getLE<int32_t>(p);
+			case INT64_TAG: return getLE<int64_t>(p);
+			default: return static_cast<int8_t>(node.tag); //fixints: 0x00-0x7F and 0xE0-0xFF are the number itself
+			}
+		}
+
+		double doubleAt(const char* data, const Node& node) {
+			const char* p = data + node.payload;
+			return node.tag == FLOAT_TAG ? getLE<float>(p) : getLE<double>(p);
+		}
+
+		class BinaryWriter {
+			std::string _body;
+			//first pass counts uses of every string, the ones used more than once go to table
+			std::unordered_map<std::string_view, uint32_t> _uses;
+			std::vector<std::string_view> _seen;
+			std::unordered_map<std::string_view, uint32_t> _index;
+			std::vector<std::string_view> _strings;
+			//second pass measures byte size of every container's entries, in the order they are written
+			std::vector<uint32_t> _sizes;
+			size_t _nextSize{ 0 };
+
+			void countStrings(const Value& value) {
+				auto use = [this](std::string_view str) {
+					if (_uses[str]++ == 0) {
+						_seen.push_back(str);
+					}
+				};
+				if (value.is<JString>()) {
+					use(value.getAs<std::string>());
+				} else if (value.is<JArray>()) {
+					for (const auto& item : value.getAs<JArray>().value()) {
+						countStrings(item.value());
+					}
+				} else if (value.is<JObject>()) {
+					for (const auto& [key, item] : value.getAs<JObject>().value()) {
+						use(key);
+						countStrings(item.value());
+					}
+				}
+			}
+
+			//most used strings get the smallest indexes, so they fit in the tag
+			void buildTable() {
+				for (auto str : _seen) {
+					if (_uses[str] > 1) {
+						_strings.push_back(str);
+					}
+				}
+				std::stable_sort(_strings.begin(), _strings.end(), [this](std::string_view left, std::string_view right) {
+					return _uses[left] > _uses[right];
+				});
+				if (_strings.size() > UINT32_MAX) throw std::length_error("binary snapshot holds more than 2^32 strings");
+				for (size_t i = 0; i < _strings.size(); ++i) {
+					_index.emplace(_strings[i], static_cast<uint32_t>(i));
+				}
+			}
+
+			static size_t widthOf(uint64_t number) {
+				return number <= UINT8_MAX ? 1 : number <= UINT16_MAX ? 2 : 4;
+			}
+
+			static bool fitsFloat(double number) {
+				return std::fabs(number) <= FLT_MAX && static_cast<double>(static_cast<float>(number)) == number;
+			}
+
+			static size_t intSize(int64_t number) {
+				if (number >= -32 && number <= 127) return 1;
+				if (number >= INT8_MIN && number <= INT8_MAX) return 1 + sizeof(int8_t);
+				if (number >= INT16_MIN && number <= INT16_MAX) return 1 + sizeof(int16_t);
+				if (number >= INT32_MIN && number <= INT32_MAX) return 1 + sizeof(int32_t);
+				return 1 + sizeof(int64_t);
+			}
+
+			static size_t doubleSize(double number) {
+				return 1 + (fitsFloat(number) ? sizeof(float) : sizeof(double));
+			}
+
+			size_t stringSize(std::string_view str) const {
+				if (auto it = _index.find(str); it != _index.end()) {
+					return it->second < 32 ? 1 : 1 + widthOf(it->second);
+				}
+				if (str.size() > UINT32_MAX) throw std::length_error("binary snapshot string is longer than 4GB");
+				return 1 + widthOf(str.size()) + str.size();
+			}
+
+			static size_t containerHeaderSize(size_t count, size_t byteSize) {
+				if (count < 16 && byteSize <= UINT8_MAX) return 2;
+				if (count <= UINT16_MAX && byteSize <= UINT16_MAX) return 5;
+				return 9;
+			}
+
+			template<typename T>
+			static size_t numbersSize(NumberSpan<T> numbers) {
+				size_t size = 0;
+				for (T number : numbers) {
+					if constexpr (std::is_same_v<T, int64_t>) {
+						size += intSize(number);
+					} else {
+						size += doubleSize(number);
+					}
+				}
+				return size;
+			}
+
+			size_t measure(const Value& value) {
+				if (value.is<int64_t>()) {
+					return intSize(value.getAs<int64_t>());
+				} else if (value.is<double>()) {
+					return doubleSize(value.getAs<double>());
+				} else if (value.is<JString>()) {
+					return stringSize(value.getAs<std::string>());
+				}
+				size_t slot = _sizes.size();
+				size_t count = 0;
+				size_t byteSize = 0;
+				if (value.is<JArray>()) {
+					_sizes.emplace_back();
+					const auto& arr = value.getAs<JArray>().value();
+					count = arr.size();
+					for (const auto& item : arr) {
+						byteSize += measure(item.value());
+					}
+				} else if (value.is<JIntArray>()) {
+					_sizes.emplace_back();
+					count = value.getNumbers<int64_t>().size();
+					byteSize = numbersSize(value.getNumbers<int64_t>());
+				} else if (value.is<JDoubleArray>()) {
+					_sizes.emplace_back();
+					count = value.getNumbers<double>().size();
+					byteSize = numbersSize(value.getNumbers<double>());
+				} else if (value.is<JObject>()) {
+					_sizes.emplace_back();
+					const auto& map = value.getAs<JObject>().value();
+					count = map.size();
+					for (const auto& [key, item] : map) {
+						byteSize += stringSize(key) + measure(item.value());
+					}
+				} else {
+					return 1; //null, false and true are the tag alone
+				}
+				if (count > UINT32_MAX || byteSize > UINT32_MAX) throw std::length_error("binary snapshot container is larger than 4GB");
+				_sizes[slot] = static_cast<uint32_t>(byteSize);
+				return containerHeaderSize(count, byteSize) + byteSize;
+			}
+
+			void writeWidth(Tag tag8, uint32_t number) {
+				size_t width = widthOf(number);
+				_body += static_cast<char>(tag8 + (width == 1 ? 0 : width == 2 ? 1 : 2));
+				if (width == 1) {
+					putLE(_body, static_cast<uint8_t>(number));
+				} else if (width == 2) {
+					putLE(_body, static_cast<uint16_t>(number));
+				} else {
+					putLE(_body, number);
+				}
+			}
+
+			void writeInt(int64_t number) {
+				if (number >= -32 && number <= 127) {
+					_body += static_cast<char>(static_cast<int8_t>(number));
+				} else if (number >= INT8_MIN && number <= INT8_MAX) {
+					_body += static_cast<char>(INT8_TAG);
+					putLE(_body, static_cast<int8_t>(number));
+				} else if (number >= INT16_MIN && number <= INT16_MAX) {
+					_body += static_cast<char>(INT16_TAG);
+					putLE(_body, static_cast<int16_t>(number));
+				} else if (number >= INT32_MIN && number <= INT32_MAX) {
+					_body += static_cast<char>(INT32_TAG);
+					putLE(_body, static_cast<int32_t>(number));
+				} else {
+					_body += static_cast<char>(INT64_TAG);
+					putLE(_body, number);
+				}
+			}
+
+			void writeDouble(double number) {
+				if (fitsFloat(number)) {
+					_body += static_cast<char>(FLOAT_TAG);
+					putLE(_body, static_cast<float>(number));
+				} else {
+					_body += static_cast<char>(DOUBLE_TAG);
+					putLE(_body, number);
+				}
+			}
+
+			void writeString(std::string_view str) {
+				if (auto it = _index.find(str); it != _index.end()) {
+					if (it->second < 32) {
+						_body += static_cast<char>(FIXREF_TAG + it->second);
+					} else {
+						writeWidth(REF8_TAG, it->second);
+					}
+				} else {
+					writeWidth(STR8_TAG, static_cast<uint32_t>(str.size()));
+					_body.append(str.data(), str.size());
+				}
+			}
+
+			//byte size comes from measure(), containers are visited in the same order
+			void writeContainerHeader(Tag fixTag, Tag tag16, size_t count) {
+				uint32_t byteSize = _sizes[_nextSize++];
+				if (count < 16 && byteSize <= UINT8_MAX) {
+					_body += static_cast<char>(fixTag + count);
+					putLE(_body, static_cast<uint8_t>(byteSize));
+				} else if (count <= UINT16_MAX && byteSize <= UINT16_MAX) {
+					_body += static_cast<char>(tag16);
+					putLE(_body, static_cast<uint16_t>(count));
+					putLE(_body, static_cast<uint16_t>(byteSize));
+				} else {
+					_body += static_cast<char>(tag16 + 1);
+					putLE(_body, static_cast<uint32_t>(count));
+					putLE(_body, byteSize);
+				}
+			}
+
+			//packed arrays are stored as ordinary arrays
+			template<typename T>
+			void writeNumbers(NumberSpan<T> numbers) {
+				writeContainerHeader(FIXARRAY_TAG, ARRAY16_TAG, numbers.size());
+				for (T number : numbers) {
+					if constexpr (std::is_same_v<T, int64_t>) {
+						writeInt(number);
+					} else {
+						writeDouble(number);
+					}
+				}
+			}
+
+			void write(const Value& value) {
+				if (value.is<JEmpty>()) {
+					_body += static_cast<char>(NULL_TAG);
+				} else if (value.is<JBool>()) {
+					_body += static_cast<char>(value.getAs<bool>() ? TRUE_TAG : FALSE_TAG);
+				} else if (value.is<int64_t>()) {
+					writeInt(value.getAs<int64_t>());
+				} else if (value.is<double>()) {
+					writeDouble(value.getAs<double>());
+				} else if (value.is<JString>()) {
+					writeString(value.getAs<std::string>());
+				} else if (value.is<JArray>()) {
+					const auto& arr = value.getAs<JArray>().value();
+					writeContainerHeader(FIXARRAY_TAG, ARRAY16_TAG, arr.size());
+					for (const auto& item : arr) {
+						write(item.value());
+					}
+				} else if (value.is<JIntArray>()) {
+					writeNumbers(value.getNumbers<int64_t>());
+				} else if (value.is<JDoubleArray>()) {
+					writeNumbers(value.getNumbers<double>());
+				} else if (value.is<JObject>()) {
+					const auto& map = value.getAs<JObject>().value();
+					writeContainerHeader(FIXOBJECT_TAG, OBJECT16_TAG, map.size());
+					for (const auto& [key, item] : map) {
+						writeString(key);
+						write(item.value());
+					}
+				}
+			}
+
+		public:
+			std::string run(const Value& value) {
+				countStrings(value);
+				buildTable();
+				_body.reserve(measure(value));
+				write(value);
+
+				std::string result(magic, sizeof(magic));
+				putLE(result, static_cast<uint32_t>(_strings.size()));
+				uint64_t offset = 0;
+				putLE(result, uint32_t{ 0 });
+				for (const auto& str : _strings) {
+					offset += str.size();
+					if (offset > UINT32_MAX) throw std::length_error("binary snapshot strings take more than 4GB");
+					putLE(result, static_cast<uint32_t>(offset));
+				}
+				result.reserve(result.size() + offset + _body.size());
+				for (const auto& str : _strings) {
+					result.append(str.data(), str.size());
+				}
+				result += _body;
+				return result;
+			}
+		};
+
+		class MessagePackWriter {
+			std::string& _out;
+
+			void writeLength(size_t size, uint8_t fix, size_t fixLimit, uint8_t base8, uint8_t base16, uint8_t base32) {
+				if (size < fixLimit) {
+					_out += static_cast<char>(fix | size);
+				} else if (base8 != 0 && size <= 0xFF) {
+					_out += static_cast<char>(base8);
+					putBE(_out, static_cast<uint8_t>(size));
+				} else if (size <= 0xFFFF) {
+					_out += static_cast<char>(base16);
+					putBE(_out, static_cast<uint16_t>(size));
+				} else {
+					_out += static_cast<char>(base32);
+					putBE(_out, static_cast<uint32_t>(size));
+				}
+			}
+
+			void writeString(const std::string& str) {
+				writeLength(str.size(), 0xA0, 32, 0xD9, 0xDA, 0xDB);
+				_out += str;
+			}
+
+			void writeInt(int64_t number) {
+				if (number >= 0 && number <= 0x7F) {
+					_out += static_cast<char>(number);
+				} else if (number < 0 && number >= -32) {
+					_out += static_cast<char>(static_cast<int8_t>(number));
+				} else if (number >= INT32_MIN && number <= INT32_MAX) {
+					_out += static_cast<char>(0xD2);
+					putBE(_out, static_cast<int32_t>(number));
+				} else {
+					_out += static_cast<char>(0xD3);
+					putBE(_out, number);
+				}
+			}
+
+			template<typename T>
+			void writeNumbers(NumberSpan<T> numbers) {
+				writeLength(numbers.size(), 0x90, 16, 0, 0xDC, 0xDD);
+				for (T number : numbers) {
+					if constexpr (std::is_same_v<T, int64_t>) {
+						writeInt(number);
+					} else {
+						_out += static_cast<char>(0xCB);
+						putBE(_out, number);
+					}
+				}
+			}
+
+		public:
+			explicit MessagePackWriter(std::string& out) : _out{ out } {}
+
+			void write(const Value& value) {
+				if (value.is<JEmpty>()) {
+					_out += static_cast<char>(0xC0);
+				} else if (value.is<JBool>()) {
+					_out += static_cast<char>(value.getAs<bool>() ? 0xC3 : 0xC2);
+				} else if (value.is<int64_t>()) {
+					writeInt(value.getAs<int64_t>());
+				} else if (value.is<double>()) {
+					_out += static_cast<char>(0xCB);
+					putBE(_out, value.getAs<double>());
+				} else if (value.is<JString>()) {
+					writeString(value.getAs<std::string>());
+				} else if (value.is<JArray>()) {
+					const auto& arr = value.getAs<JArray>().value();
+					writeLength(arr.size(), 0x90, 16, 0, 0xDC, 0xDD);
+					for (const auto& item : arr) {
+						write(item.value());
+					}
+				} else if (value.is<JIntArray>()) {
+					writeNumbers(value.getNumbers<int64_t>());
+				} else if (value.is<JDoubleArray>()) {
+					writeNumbers(value.getNumbers<double>());
+				} else if (value.is<JObject>()) {
+					const auto& map = value.getAs<JObject>().value();
+					writeLength(map.size(), 0x80, 16, 0, 0xDE, 0xDF);
+					for (const auto& [key, item] : map) {
+						writeString(key);
+						write(item.value());
+					}
+				}
+			}
+		};
+
+		size_t blobStart(uint32_t stringCount) {
+			return headerSize + sizeof(uint32_t) * (static_cast<size_t>(stringCount) + 1);
+		}
+
+		//string table check, returns offset of root node or 0 if header is broken
+		size_t readHeader(std::string_view data, uint32_t& stringCount) {
+			if (data.size() < headerSize || std::memcmp(data.data(), magic, sizeof(magic)) != 0) return 0;
+			stringCount = getLE<uint32_t>(data.data() + sizeof(magic));
+			size_t blob = blobStart(stringCount);
+			if (data.size() < blob) return 0;
+			uint32_t previous = 0;
+			for (uint32_t i = 0; i <= stringCount; ++i) {
+				uint32_t offset = getLE<uint32_t>(data.data() + headerSize + sizeof(uint32_t) * i);
+				if (offset < previous || offset > data.size() - blob) return 0;
+				previous = offset;
+			}
+			size_t root = blob + previous;
+			return root < data.size() ? root : 0;
+		}
+
+		//expects header to be checked by readHeader, false for reference out of table
+		bool stringAt(std::string_view data, uint32_t stringCount, const Node& node, std::string_view& str) {
+			if (node.tag >= STR8_TAG) {
+				str = data.substr(node.payload, node.count);
+				return true;
+			}
+			if (node.count >= stringCount) return false;
+			const char* offsets = data.data() + headerSize + sizeof(uint32_t) * node.count;
+			uint32_t begin = getLE<uint32_t>(offsets);
+			uint32_t end = getLE<uint32_t>(offsets + sizeof(uint32_t));
+			str = data.substr(blobStart(stringCount) + begin, end - begin);
+			return true;
+		}
+
+		//sequential reader used to materialize Value, every read is bounds checked
+		class BinaryReader {
+			std::string_view _data;
+			uint32_t _stringCount;
+			size_t _pos;
+
+			bool readString(std::string_view& str) {
+				Node node;
+				if (!decode(_data, _pos, node) || node.kind != STRING_KIND || !stringAt(_data, _stringCount, node, str)) return false;
+				_pos = node.end;
+				return true;
+			}
+
+		public:
+			BinaryReader(std::string_view data, uint32_t stringCount, size_t pos) : _data{ data }, _stringCount{ stringCount }, _pos{ pos } {}
+
+			bool read(Value& value) {
+				Node node;
+				if (!decode(_data, _pos, node)) return false;
+				switch (node.kind) {
+				case NULL_KIND:
+					break;
+				case BOOL_KIND:
+					value = node.tag == TRUE_TAG;
+					break;
+				case INT_KIND:
+					value.emplace<JNumber>(intAt(_data.data(), node));
+					break;
+				case DOUBLE_KIND:
+					value.emplace<JNumber>(doubleAt(_data.data(), node));
+					break;
+				case STRING_KIND: {
+					std::string_view str;
+					if (!stringAt(_data, _stringCount, node, str)) return false;
+					value.emplace<JString>(std::string(str));
+					break;
+				}
+				case ARRAY_KIND: {
+					auto& arr = value.emplace<JArray>();
+					arr->reserve(node.count);
+					_pos = node.payload;
+					for (uint32_t i = 0; i < node.count; ++i) {
+						if (!read(*arr->emplace_back())) return false;
+					}
+					//entries must fill byte size exactly, otherwise BinaryView would see other nodes
+					return _pos == node.end;
+				}
+				case OBJECT_KIND: {
+					auto& map = value.emplace<JObject>();
+					map->reserve(node.count);
+					_pos = node.payload;
+					for (uint32_t i = 0; i < node.count; ++i) {
+						std::string_view key;
+						if (!readString(key)) return false;
+						if (!read(*map->try_emplace(std::string(key)).first->second)) return false;
+					}
+					return _pos == node.end;
+				}
+				default:
+					return false;
+				}
+				_pos = node.end;
+				return true;
+			}
+
+			bool atEnd() const {
+				return _pos == _data.size();
+			}
+		};
+	}
+
+	std::string toBinary(const Value& value) {
+		return BinaryWriter().run(value);
+	}
+
+	std::optional<Value> fromBinary(std::string_view data) {
+		uint32_t stringCount;
+		size_t root = readHeader(data, stringCount);
+		if (root == 0) return std::nullopt;
+		BinaryReader reader(data, stringCount, root);
+		Value result;
+		if (!reader.read(result) || !reader.atEnd()) return std::nullopt;
+		return std::optional{ std::move(result) };
+	}
+
+	std::string toMessagePack(const Value& value) {
+		std::string result;
+		MessagePackWriter writer(result);
+		writer.write(value);
+		return result;
+	}
+
+	std::optional<BinaryView> BinaryView::open(std::string_view data) {
+		uint32_t stringCount;
+		size_t root = readHeader(data, stringCount);
+		if (root == 0) return std::nullopt;
+		return BinaryView(data, root, stringCount);
+	}
+
+	_binary::Kind BinaryView::kind() const {
+		Node node;
+		return decode(_data, _offset, node) ? node.kind : INVALID_KIND;
+	}
+
+	size_t BinaryView::nodeEnd(size_t offset) const {
+		Node node;
+		return decode(_data, offset, node) ? node.end : npos;
+	}
+
+	bool BinaryView::getBool() const {
+		Node node;
+		if (!decode(_data, _offset, node) || node.kind != BOOL_KIND) throw std::bad_variant_access();
+		return node.tag == TRUE_TAG;
+	}
+
+	int64_t BinaryView::getInt() const {
+		Node node;
+		if (!decode(_data, _offset, node)) throw std::bad_variant_access();
+		if (node.kind == INT_KIND) return intAt(_data.data(), node);
+		if (node.kind == DOUBLE_KIND) return static_cast<int64_t>(doubleAt(_data.data(), node));
+		throw std::bad_variant_access();
+	}
+
+	double BinaryView::getDouble() const {
+		Node node;
+		if (!decode(_data, _offset, node)) throw std::bad_variant_access();
+		if (node.kind == DOUBLE_KIND) return doubleAt(_data.data(), node);
+		if (node.kind == INT_KIND) return static_cast<double>(intAt(_data.data(), node));
+		throw std::bad_variant_access();
+	}
+
+	std::string_view BinaryView::getString() const {
+		Node node;
+		if (!decode(_data, _offset, node) || node.kind != STRING_KIND) throw std::bad_variant_access();
+		std::string_view str;
+		stringAt(_data, _stringCount, node, str);
+		return str;
+	}
+
+	size_t BinaryView::size() const {
+		Node node;
+		if (!decode(_data, _offset, node) || (node.kind != ARRAY_KIND && node.kind != OBJECT_KIND)) return 0;
+		return node.count;
+	}
+
+	bool BinaryView::hasKey(std::string_view key) const {
+		return !(*this)[key]._data.empty();
+	}
+
+	BinaryView BinaryView::operator[](std::string_view key) const {
+		Node node;
+		if (!decode(_data, _offset, node) || node.kind != OBJECT_KIND) return BinaryView();
+		size_t pos = node.payload;
+		for (uint32_t i = 0; i < node.count; ++i) {
+			Node keyNode;
+			std::string_view name;
+			if (!decode(_data, pos, keyNode) || keyNode.kind != STRING_KIND || !stringAt(_data, _stringCount, keyNode, name)) return BinaryView();
+			if (name == key) {
+				return BinaryView(_data, keyNode.end, _stringCount);
+			}
+			pos = nodeEnd(keyNode.end);
+		}
+		return BinaryView();
+	}
+
+	BinaryView BinaryView::operator[](size_t index) const {
+		Node node;
+		if (!decode(_data, _offset, node) || node.kind != ARRAY_KIND || index >= node.count) return BinaryView();
+		size_t pos = node.payload;
+		for (size_t i = 0; i < index && pos != npos; ++i) {
+			pos = nodeEnd(pos);
+		}
+		return pos == npos ? BinaryView() : BinaryView(_data, pos, _stringCount);
+	}
+
+	std::string_view BinaryView::keyAt(size_t index) const {
+		Node node;
+		if (!decode(_data, _offset, node) || node.kind != OBJECT_KIND || index >= node.count) return std::string_view();
+		size_t pos = node.payload;
+		for (size_t i = 0; i < index && pos != npos; ++i) {
+			pos = nodeEnd(nodeEnd(pos));
+		}
+		Node keyNode;
+		std::string_view name;
+		if (pos == npos || !decode(_data, pos, keyNode) || keyNode.kind != STRING_KIND || !stringAt(_data, _stringCount, keyNode, name)) return std::string_view();
+		return name;
+	}
+
+	BinaryIterator BinaryView::begin() const {
+		Node node;
+		if (!decode(_data, _offset, node) || (node.kind != ARRAY_KIND && node.kind != OBJECT_KIND)) return BinaryIterator();
+		return BinaryIterator(*this, node.payload, node.count);
+	}
+
+	BinaryIterator BinaryView::end() const {
+		return BinaryIterator();
+	}
+
+	BinaryIterator::BinaryIterator(const BinaryView& container, size_t pos, size_t count) : _container{ container }, _pos{ pos }, _left{ count } {
+		load();
+	}
+
+	void BinaryIterator::load() {
+		if (_left == 0) return;
+		const auto& data = _container._data;
+		size_t valuePos = _pos;
+		_entry.key = std::string_view();
+		if (_container.kind() == OBJECT_KIND) {
+			Node keyNode;
+			if (!decode(data, _pos, keyNode) || keyNode.kind != STRING_KIND || !stringAt(data, _container._stringCount, keyNode, _entry.key)) {
+				_left = 0;
+				return;
+			}
+			valuePos = keyNode.end;
+		}
+		_entry.value = BinaryView(data, valuePos, _container._stringCount);
+	}
+
+	BinaryIterator& BinaryIterator::operator++() {
+		if (_left == 0) return *this;
+		_pos = _container.nodeEnd(_entry.value._offset);
+		_left = _pos == npos ? 0 : _left - 1;
+		load();
+		return *this;
+	}
+
+	Value BinaryView::toValue() const {
+		Value result;
+		BinaryReader reader(_data, _stringCount, _offset);
+		if (_offset >= _data.size() || !reader.read(result)) return Value();
+		return result;
+	}
+}
@@ -0,0 +1,176 @@
+//
+//  infyJSON lib
+//
+#pragma once
+
+#include "Value.h"
+#include <cstdint>
+#include <iterator>
+#include <optional>
+#include <string_view>
+
+namespace JSON {
+
+	//Binary snapshot layout (fixed-width integers are little-endian):
+	//  "IJB2" | u32 stringCount | u32 offsets[stringCount + 1] | string bytes | root node
+	//Node starts with one tag byte (_binary::Tag), small values live in the tag itself like in MessagePack:
+	//  ints -32..127, references to the first 32 table strings, arrays and objects with up to 15 entries.
+	//Other tags are followed by payload of the width the tag names. Strings used more than once are stored
+	//in the table once and referenced by index, the rest are inline. Object entries are (key, value) pairs of nodes.
+	//Array and object headers hold entry count and byte size of the entries, so readers step over containers without descending.
+	std::string toBinary(const Value& value);
+	std::optional<Value> fromBinary(std::string_view data);
+
+	//MessagePack encoding of Value, can be read by any MessagePack implementation
+	std::string toMessagePack(const Value& value);
+
+	namespace _binary {
+		enum Tag : uint8_t {
+			FIXINT_TAG = 0x00, //0x00-0x7F: int 0..127
+			FIXOBJECT_TAG = 0x80, //0x80-0x8F: object with 0..15 entries, u8 byteSize
+			FIXARRAY_TAG = 0x90, //0x90-0x9F: array with 0..15 elements, u8 byteSize
+			FIXREF_TAG = 0xA0, //0xA0-0xBF: table string 0..31
+			NULL_TAG = 0xC0,
+			FALSE_TAG = 0xC2,
+			TRUE_TAG = 0xC3,
+			FLOAT_TAG = 0xCA, //doubles which are exact as float
+			DOUBLE_TAG = 0xCB,
+			REF8_TAG = 0xCC,
+			REF16_TAG = 0xCD,
+			REF32_TAG = 0xCE,
+			INT8_TAG = 0xD0,
+			INT16_TAG = 0xD1,
+			INT32_TAG = 0xD2,
+			INT64_TAG = 0xD3,
+			STR8_TAG = 0xD9, //inline string, u8 length
+			STR16_TAG = 0xDA,
+			STR32_TAG = 0xDB,
+			ARRAY16_TAG = 0xDC, //u16 count, u16 byteSize
+			ARRAY32_TAG = 0xDD, //u32 count, u32 byteSize
+			OBJECT16_TAG = 0xDE,
+			OBJECT32_TAG = 0xDF,
+			NEGATIVE_FIXINT_TAG = 0xE0 //0xE0-0xFF: int -32..-1
+		};
+
+		//what node holds, whatever tag it's written with
+		enum Kind : uint8_t {
+			NULL_KIND,
+			BOOL_KIND,
+			INT_KIND,
+			DOUBLE_KIND,
+			STRING_KIND,
+			ARRAY_KIND,
+			OBJECT_KIND,
+			INVALID_KIND
+		};
+	}
+
+	class BinaryIterator;
+
+	//Read-only view over binary snapshot (e.g. mmap'ed file), nothing is deserialized.
+	//Missing keys and out of range indexes give view for which is<JEmpty>() is true, like Value's const operator[].
+	class BinaryView {
+		friend class BinaryIterator;
+
+		std::string_view _data;
+		size_t _offset{ 0 };
+		uint32_t _stringCount{ 0 };
+
+		BinaryView(std::string_view data, size_t offset, uint32_t stringCount) : _data{ data }, _offset{ offset }, _stringCount{ stringCount } {}
+
+		_binary::Kind kind() const;
+		size_t nodeEnd(size_t offset) const;
+
+	public:
+		BinaryView() = default;
+
+		//checks header and string table, returns nullopt when data isn't a binary snapshot
+		static std::optional<BinaryView> open(std::string_view data);
+
+		template<typename T>
+		bool is() const {
+			using decayed_t = std::decay_t<T>;
+			auto k = kind();
+			if constexpr (std::is_same_v<decayed_t, JEmpty>) {
+				return k == _binary::NULL_KIND || k == _binary::INVALID_KIND;
+			} else if constexpr (std::is_same_v<decayed_t, JBool>) {
+				return k == _binary::BOOL_KIND;
+			} else if constexpr (std::is_same_v<decayed_t, JNumber>) {
+				return k == _binary::INT_KIND || k == _binary::DOUBLE_KIND;
+			} else if constexpr (std::is_same_v<decayed_t, JString>) {
+				return k == _binary::STRING_KIND;
+			} else if constexpr (std::is_same_v<decayed_t, JArray>) {
+				return k == _binary::ARRAY_KIND;
+			} else if constexpr (std::is_same_v<decayed_t, JObject>) {
+				return k == _binary::OBJECT_KIND;
+			} else {
+				static_assert(std::is_same_v<decayed_t, JEmpty>, "BinaryView::is<T>() expects one of J<Something> types");
+				return false;
+			}
+		}
+
+		bool getBool() const;
+		int64_t getInt() const;
+		double getDouble() const;
+		std::string_view getString() const;
+
+		//number of elements in array or keys in object
+		size_t size() const;
+		bool hasKey(std::string_view key) const;
+		//lookups step over siblings from the start of container, use begin()/end() to visit all of them
+		BinaryView operator[](std::string_view key) const;
+		BinaryView operator[](size_t index) const;
+		//key of object's index-th entry
+		std::string_view keyAt(size_t index) const;
+
+		//elements of array or entries of object in one pass, empty range for everything else
+		BinaryIterator begin() const;
+		BinaryIterator end() const;
+
+		Value toValue() const;
+	};
+
+	struct BinaryEntry {
+		std::string_view key; //empty for array elements
+		BinaryView value;
+	};
+
+	//remembers offset of the current child, so every step is O(1)
+	class BinaryIterator {
+		BinaryView _container;
+		size_t _pos{ 0 };
+		size_t _left{ 0 };
+		BinaryEntry _entry;
+
+		void load();
+
+	public:
+		using iterator_category = std::input_iterator_tag;
+		using value_type = BinaryEntry;
+		using difference_type = std::ptrdiff_t;
+		using pointer = const BinaryEntry*;
+		using reference = const BinaryEntry&;
+
+		BinaryIterator() = default;
+		BinaryIterator(const BinaryView& container, size_t pos, size_t count);
+
+		const BinaryEntry& operator*() const {
+			return _entry;
+		}
+
+		const BinaryEntry* operator->() const {
+			return &_entry;
+		}
+
+		BinaryIterator& operator++();
+
+		//iterators of one container are compared by number of entries left
+		bool operator==(const BinaryIterator& right) const {
+			return _left == right._left;
+		}
+
+		bool operator!=(const BinaryIterator& right) const {
+			return _left != right._left;
+		}
+	};
+}
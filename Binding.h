@@ -0,0 +1,496 @@
+//
+//  infyJSON lib
+//
+#pragma once
+
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+//Describes one member of a bound struct: INFYJSON_FIELD(Person, name) -> field "name" bound to &Person::name
+#define INFYJSON_FIELD(Type, member) ::JSON::field(#member, &Type::member)
+
+namespace JSON {
+
+	//Specialize for your struct with `static constexpr auto list = std::make_tuple(INFYJSON_FIELD(...), ...);`
+	template<typename T>
+	struct Fields;
+
+	//Specialize for your enum with `static constexpr std::pair<E, const char*> list[] = { ... };`
+	//Enums without names are read and written as their underlying integer.
+	template<typename E>
+	struct EnumNames;
+
+	template<typename Class, typename Member>
+	struct Field {
+		const char* name;
+		std::size_t length;
+		Member Class::* member;
+	};
+
+	template<typename Class, typename Member>
+	constexpr Field<Class, Member> field(const char* name, Member Class::* member) {
+		std::size_t length = 0;
+		while (name[length] != '\0') ++length;
+		return { name, length, member };
+	}
+
+	namespace _binding {
+
+		template<typename T, typename = void>
+		struct has_fields : std::false_type {};
+		template<typename T>
+		struct has_fields<T, std::void_t<decltype(Fields<T>::list)>> : std::true_type {};
+
+		template<typename T, typename = void>
+		struct has_enum_names : std::false_type {};
+		template<typename T>
+		struct has_enum_names<T, std::void_t<decltype(EnumNames<T>::list)>> : std::true_type {};
+
+		template<typename T>
+		struct is_vector : std::false_type {};
+		template<typename T, typename A>
+		struct is_vector<std::vector<T, A>> : std::true_type {};
+
+		template<typename T>
+		struct is_optional : std::false_type {};
+		template<typename T>
+		struct is_optional<std::optional<T>> : std::true_type {};
+
+		template<typename T>
+		struct is_string_map : std::false_type {};
+		template<typename T, typename C, typename A>
+		struct is_string_map<std::map<std::string, T, C, A>> : std::true_type {};
+		template<typename T, typename H, typename E, typename A>
+		struct is_string_map<std::unordered_map<std::string, T, H, E, A>> : std::true_type {};
+
+		template<typename T>
+		struct dependent_false : std::false_type {};
+
+		class Reader {
+			const char* _pos;
+			const char* _last;
+		public:
+			explicit Reader(std::string_view json) : _pos{ json.data() }, _last{ json.data() + json.size() } {}
+
+			bool isEOF() const {
+				return _pos == _last;
+			}
+
+			//skips whitespace and returns next char without consuming it, '\0' on EOF
+			char peek() {
+				while (_pos != _last && (*_pos == ' ' || *_pos == '\t' || *_pos == '\n' || *_pos == '\r')) {
+					++_pos;
+				}
+				return _pos == _last ? '\0' : *_pos;
+			}
+
+			bool consume(char c) {
+				if (peek() != c) return false;
+				++_pos;
+				return true;
+			}
+
+			bool consumeWord(std::string_view word) {
+				peek();
+				if (static_cast<std::size_t>(_last - _pos) < word.size() || std::memcmp(_pos, word.data(), word.size()) != 0) {
+					return false;
+				}
+				_pos += word.size();
+				return true;
+			}
+
+			//returns raw string contents between quotes, escapes are kept as is; enough for keys and enum names
+			bool readString(std::string_view& result) {
+				if (!consume('\"')) return false;
+				const char* begin = _pos;
+				bool escaped = false;
+				for (; _pos != _last; ++_pos) {
+					char c = *_pos;
+					if (c >= '\x00' && c <= '\x1F') return false;
+					if (c == '\\') {
+						escaped = !escaped;
+					} else if (c == '\"' && !escaped) {
+						result = std::string_view(begin, static_cast<std::size_t>(_pos - begin));
+						++_pos;
+						return true;
+					} else {
+						escaped = false;
+					}
+				}
+				return false;
+			}
+
+			//decodes escapes, \uXXXX (with surrogate pairs) becomes UTF-8
+			bool readString(std::string& result) {
+				std::string_view raw;
+				if (!readString(raw)) return false;
+				result.clear();
+				result.reserve(raw.size());
+				for (std::size_t i = 0; i < raw.size(); ++i) {
+					if (raw[i] != '\\') {
+						result += raw[i];
+						continue;
+					}
+					switch (raw[++i]) { //raw can't end with single '\'
+					case '\"': result += '\"'; break;
+					case '\\': result += '\\'; break;
+					case '/': result += '/'; break;
+					case 'b': result += '\b'; break;
+					case 'f': result += '\f'; break;
+					case 'n': result += '\n'; break;
+					case 'r': result += '\r'; break;
+					case 't': result += '\t'; break;
+					case 'u': {
+						unsigned long code = 0;
+						if (!readHex(raw, i, code)) return false;
+						if (code >= 0xD800 && code <= 0xDBFF) {
+							unsigned long low = 0;
+							if (raw.substr(i + 1, 2) != "\\u") return false;
+							i += 2;
+							if (!readHex(raw, i, low) || low < 0xDC00 || low > 0xDFFF) return false;
+							code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+						} else if (code >= 0xDC00 && code <= 0xDFFF) {
+							return false;
+						}
+						appendUtf8(code, result);
+						break;
+					}
+					default:
+						return false;
+					}
+				}
+				return true;
+			}
+
+			template<typename T>
+			bool readNumber(T& result) {
+				peek();
+				const char* end = _pos;
+				bool hasFloatingPoint = false;
+				while (end != _last && (std::isdigit(static_cast<unsigned char>(*end)) || *end == '-' || *end == '+' || *end == '.' || *end == 'e' || *end == 'E')) {
+					hasFloatingPoint = hasFloatingPoint || *end == '.' || *end == 'e' || *end == 'E';
+					++end;
+				}
+				if (end == _pos) return false;
+				std::from_chars_result res;
+				if constexpr (std::is_integral_v<T>) {
+					if (hasFloatingPoint) {
+						//1e3 or 2.0 fit integral field, 3.7 and anything out of T's range don't
+						double d;
+						res = std::from_chars(_pos, end, d);
+						double upper = std::ldexp(1.0, std::numeric_limits<T>::digits);
+						double lower = std::is_signed_v<T> ? -upper : 0.0;
+						if (res.ec != std::errc() || !(d >= lower && d < upper) || std::trunc(d) != d) return false;
+						result = static_cast<T>(d);
+					} else {
+						res = std::from_chars(_pos, end, result);
+					}
+				} else {
+					double d;
+					res = std::from_chars(_pos, end, d);
+					if (res.ec == std::errc() && std::isfinite(d) && std::fabs(d) > static_cast<double>(std::numeric_limits<T>::max())) return false;
+					result = static_cast<T>(d);
+				}
+				if (res.ec != std::errc() || res.ptr != end) return false;
+				_pos = end;
+				return true;
+			}
+
+		private:
+			//4 hex digits after raw[i] == 'u', i is left at the last of them
+			static bool readHex(std::string_view raw, std::size_t& i, unsigned long& code) {
+				if (raw.size() - i < 5) return false;
+				auto res = std::from_chars(raw.data() + i + 1, raw.data() + i + 5, code, 16);
+				if (res.ec != std::errc() || res.ptr != raw.data() + i + 5) return false;
+				i += 4;
+				return true;
+			}
+
+			static void appendUtf8(unsigned long code, std::string& result) {
+				if (code < 0x80) {
+					result += static_cast<char>(code);
+				} else if (code < 0x800) {
+					result += static_cast<char>(0xC0 | (code >> 6));
+					result += static_cast<char>(0x80 | (code & 0x3F));
+				} else if (code < 0x10000) {
+					result += static_cast<char>(0xE0 | (code >> 12));
+					result += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+					result += static_cast<char>(0x80 | (code & 0x3F));
+				} else {
+					result += static_cast<char>(0xF0 | (code >> 18));
+					result += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+					result += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+					result += static_cast<char>(0x80 | (code & 0x3F));
+				}
+			}
+
+		public:
+			bool skipValue() {
+				switch (peek()) {
+				case '{':
+					++_pos;
+					if (consume('}')) return true;
+					do {
+						std::string_view key;
+						if (!readString(key) || !consume(':') || !skipValue()) return false;
+					} while (consume(','));
+					return consume('}');
+				case '[':
+					++_pos;
+					if (consume(']')) return true;
+					do {
+						if (!skipValue()) return false;
+					} while (consume(','));
+					return consume(']');
+				case '\"': {
+					std::string_view dummy;
+					return readString(dummy);
+				}
+				case 't':
+					return consumeWord("true");
+				case 'f':
+					return consumeWord("false");
+				case 'n':
+					return consumeWord("null");
+				default: {
+					double dummy;
+					return readNumber(dummy);
+				}
+				}
+			}
+		};
+
+		template<typename T>
+		bool read(Reader& reader, T& result);
+
+		template<typename T, std::size_t... I>
+		bool readField(Reader& reader, T& result, std::string_view key, std::index_sequence<I...>) {
+			constexpr auto& list = Fields<T>::list;
+			bool found = false;
+			bool ok = true;
+			//lengths are known at compile time, so most of the names are rejected without touching characters
+			((!found && std::get<I>(list).length == key.size() && std::memcmp(std::get<I>(list).name, key.data(), key.size()) == 0
+				? (found = true, ok = read(reader, result.*(std::get<I>(list).member)))
+				: false), ...);
+			return found ? ok : reader.skipValue();
+		}
+
+		template<typename T>
+		bool readStruct(Reader& reader, T& result) {
+			if (!reader.consume('{')) return false;
+			if (reader.consume('}')) return true;
+			constexpr std::size_t size = std::tuple_size_v<std::decay_t<decltype(Fields<T>::list)>>;
+			do {
+				std::string_view key;
+				if (!reader.readString(key) || !reader.consume(':')) return false;
+				if (!readField(reader, result, key, std::make_index_sequence<size>{})) return false;
+			} while (reader.consume(','));
+			return reader.consume('}');
+		}
+
+		template<typename T>
+		bool read(Reader& reader, T& result) {
+			if constexpr (std::is_same_v<T, bool>) {
+				if (reader.consumeWord("true")) {
+					result = true;
+					return true;
+				}
+				result = false;
+				return reader.consumeWord("false");
+			} else if constexpr (std::is_arithmetic_v<T>) {
+				return reader.readNumber(result);
+			} else if constexpr (std::is_enum_v<T>) {
+				if constexpr (has_enum_names<T>::value) {
+					std::string_view name;
+					if (!reader.readString(name)) return false;
+					for (const auto& [value, valueName] : EnumNames<T>::list) {
+						if (name == valueName) {
+							result = value;
+							return true;
+						}
+					}
+					return false;
+				} else {
+					std::underlying_type_t<T> number{};
+					if (!reader.readNumber(number)) return false;
+					result = static_cast<T>(number);
+					return true;
+				}
+			} else if constexpr (std::is_same_v<T, std::string>) {
+				return reader.readString(result);
+			} else if constexpr (is_optional<T>::value) {
+				if (reader.peek() == 'n') {
+					result.reset();
+					return reader.consumeWord("null");
+				}
+				return read(reader, result.emplace());
+			} else if constexpr (is_vector<T>::value) {
+				result.clear();
+				if (!reader.consume('[')) return false;
+				if (reader.consume(']')) return true;
+				do {
+					if (!read(reader, result.emplace_back())) return false;
+				} while (reader.consume(','));
+				return reader.consume(']');
+			} else if constexpr (is_string_map<T>::value) {
+				result.clear();
+				if (!reader.consume('{')) return false;
+				if (reader.consume('}')) return true;
+				do {
+					std::string key;
+					if (!reader.readString(key) || !reader.consume(':')) return false;
+					if (!read(reader, result[std::move(key)])) return false;
+				} while (reader.consume(','));
+				return reader.consume('}');
+			} else if constexpr (has_fields<T>::value) {
+				return readStruct(reader, result);
+			} else {
+				static_assert(dependent_false<T>::value, "JSON::parseAs: type has no JSON::Fields specialization");
+				return false;
+			}
+		}
+
+		template<typename T>
+		void write(const T& value, std::string& result);
+
+		inline void writeString(std::string_view str, std::string& result) {
+			static const char hex[] = "0123456789abcdef";
+			result += '\"';
+			for (char c : str) {
+				switch (c) {
+				case '\"': result += "\\\""; break;
+				case '\\': result += "\\\\"; break;
+				case '\b': result += "\\b"; break;
+				case '\f': result += "\\f"; break;
+				case '\n': result += "\\n"; break;
+				case '\r': result += "\\r"; break;
+				case '\t': result += "\\t"; break;
+				default:
+					if (static_cast<unsigned char>(c) < 0x20) {
+						result += "\\u00";
+						result += hex[(c >> 4) & 0xF];
+						result += hex[c & 0xF];
+					} else {
+						result += c;
+					}
+				}
+			}
+			result += '\"';
+		}
+
+		//shortest form which reads back to the same number
+		template<typename T>
+		void writeNumber(T value, std::string& result) {
+			if constexpr (std::is_floating_point_v<T>) {
+				if (!std::isfinite(value)) throw std::domain_error("JSON::serialize: NaN and infinity can't be written as JSON");
+			}
+			char buf[64];
+			auto res = std::to_chars(buf, buf + sizeof(buf), value);
+			result.append(buf, res.ptr);
+		}
+
+		template<typename T, std::size_t... I>
+		void writeStruct(const T& value, std::string& result, std::index_sequence<I...>) {
+			constexpr auto& list = Fields<T>::list;
+			result += '{';
+			((result += '\"', result += std::get<I>(list).name, result += "\":", write(value.*(std::get<I>(list).member), result), result += ','), ...);
+			if (result.back() == ',') {
+				result.back() = '}';
+			} else {
+				result += '}';
+			}
+		}
+
+		template<typename T>
+		void write(const T& value, std::string& result) {
+			if constexpr (std::is_same_v<T, bool>) {
+				result += value ? "true" : "false";
+			} else if constexpr (std::is_arithmetic_v<T>) {
+				writeNumber(value, result);
+			} else if constexpr (std::is_enum_v<T>) {
+				if constexpr (has_enum_names<T>::value) {
+					for (const auto& [enumValue, name] : EnumNames<T>::list) {
+						if (enumValue == value) {
+							writeString(name, result);
+							return;
+						}
+					}
+				}
+				writeNumber(static_cast<std::underlying_type_t<T>>(value), result);
+			} else if constexpr (std::is_same_v<T, std::string>) {
+				writeString(value, result);
+			} else if constexpr (is_optional<T>::value) {
+				if (value) {
+					write(*value, result);
+				} else {
+					result += "null";
+				}
+			} else if constexpr (is_vector<T>::value) {
+				result += '[';
+				for (const auto& item : value) {
+					write(item, result);
+					result += ',';
+				}
+				if (result.back() == ',') {
+					result.back() = ']';
+				} else {
+					result += ']';
+				}
+			} else if constexpr (is_string_map<T>::value) {
+				result += '{';
+				for (const auto& [key, item] : value) {
+					writeString(key, result);
+					result += ':';
+					write(item, result);
+					result += ',';
+				}
+				if (result.back() == ',') {
+					result.back() = '}';
+				} else {
+					result += '}';
+				}
+			} else if constexpr (has_fields<T>::value) {
+				constexpr std::size_t size = std::tuple_size_v<std::decay_t<decltype(Fields<T>::list)>>;
+				writeStruct(value, result, std::make_index_sequence<size>{});
+			} else {
+				static_assert(dependent_false<T>::value, "JSON::serialize: type has no JSON::Fields specialization");
+			}
+		}
+	}
+
+	//Fills T straight from the text, without building intermediate Value
+	template<typename T>
+	std::optional<T> parseAs(std::string_view jsonString) {
+		_binding::Reader reader(jsonString);
+		T result{};
+		if (_binding::read(reader, result) && reader.peek() == '\0' && reader.isEOF()) {
+			return std::optional<T>{ std::move(result) };
+		}
+		return std::nullopt;
+	}
+
+	template<typename T>
+	void serialize(const T& value, std::string& result) {
+		_binding::write(value, result);
+	}
+
+	template<typename T>
+	std::string serialize(const T& value) {
+		std::string result;
+		_binding::write(value, result);
+		return result;
+	}
+}
@@ -0,0 +1,149 @@
+//
+//  infyJSON lib
+//
+
+#include "DocumentCache.h"
+#include "Parser.h"
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <filesystem>
+#endif
+
+namespace JSON {
+
+	namespace {
+
+		//rough heap footprint of document, used only to keep cache within its budget
+		size_t estimateMemory(const Value& value) {
+			size_t result = sizeof(Value);
+			if (value.is<JString>()) {
+				result += sizeof(std::string) + value.getAs<std::string>().capacity();
+			} else if (value.is<JArray>()) {
+				const auto& arr = value.getAs<JArray>().value();
+				result += sizeof(arr) + arr.capacity() * sizeof(JValue);
+				for (const auto& item : arr) {
+					result += estimateMemory(item.value());
+				}
+			} else if (value.isPacked()) {
+				result += sizeof(std::vector<int64_t>) + (value.is<JIntArray>() ? value.getAs<JIntArray>()->capacity() : value.getAs<JDoubleArray>()->capacity()) * sizeof(int64_t);
+			} else if (value.is<JObject>()) {
+				const auto& map = value.getAs<JObject>().value();
+				result += sizeof(map) + map.bucket_count() * sizeof(void*);
+				for (const auto& [key, item] : map) {
+					result += 2 * sizeof(void*) + sizeof(std::string) + key.capacity() + sizeof(JValue) + estimateMemory(item.value());
+				}
+			} else if (!value.is<JEmpty>()) {
+				result += sizeof(int64_t);
+			}
+			return result;
+		}
+	}
+
+	bool DocumentCache::FileStamp::operator==(const FileStamp& right) const {
+		return device == right.device && inode == right.inode && modified == right.modified && size == right.size;
+	}
+
+	std::optional<DocumentCache::FileStamp> DocumentCache::stamp(const std::string& path) {
+		FileStamp result;
+#ifdef _WIN32
+		std::error_code error;
+		auto time = std::filesystem::last_write_time(path, error);
+		if (error) return std::nullopt;
+		auto size = std::filesystem::file_size(path, error);
+		if (error) return std::nullopt;
+		result.modified = static_cast<int64_t>(time.time_since_epoch().count());
+		result.size = static_cast<uint64_t>(size);
+#else
+		struct stat info;
+		if (::stat(path.c_str(), &info) != 0 || !S_ISREG(info.st_mode)) return std::nullopt;
+		result.device = static_cast<uint64_t>(info.st_dev);
+		result.inode = static_cast<uint64_t>(info.st_ino);
+#ifdef __APPLE__
+		result.modified = static_cast<int64_t>(info.st_mtimespec.tv_sec) * 1000000000 + info.st_mtimespec.tv_nsec;
+#else
+		result.modified = static_cast<int64_t>(info.st_mtim.tv_sec) * 1000000000 + info.st_mtim.tv_nsec;
+#endif
+		result.size = static_cast<uint64_t>(info.st_size);
+#endif
+		return result;
+	}
+
+	std::shared_ptr<const Value> DocumentCache::get(std::string_view path) {
+		std::string key(path);
+		auto current = stamp(key);
+		if (!current) {
+			invalidate(path);
+			return nullptr;
+		}
+
+		{
+			std::lock_guard lock(_mutex);
+			if (auto it = _entries.find(key); it != _entries.end() && it->second.stamp == *current) {
+				_lru.splice(_lru.begin(), _lru, it->second.lru);
+				return it->second.document;
+			}
+		}
+
+		//parse outside of the lock, so readers of other documents aren't blocked
+		auto parsed = parseFromFile(key);
+		if (!parsed) {
+			invalidate(path);
+			return nullptr;
+		}
+		size_t cost = estimateMemory(*parsed);
+		auto document = std::make_shared<const Value>(std::move(*parsed));
+
+		std::lock_guard lock(_mutex);
+		auto [it, inserted] = _entries.try_emplace(key);
+		auto& entry = it->second;
+		if (inserted) {
+			_lru.push_front(key);
+			entry.lru = _lru.begin();
+		} else {
+			_lru.splice(_lru.begin(), _lru, entry.lru);
+			if (entry.stamp.modified > current->modified) {
+				return entry.document; //another thread already loaded newer version
+			}
+			_used -= entry.cost;
+		}
+		entry.stamp = *current;
+		entry.document = document;
+		entry.cost = cost;
+		_used += cost;
+		evict(key);
+		return document;
+	}
+
+	//expects _mutex to be locked
+	void DocumentCache::evict(const std::string& keep) {
+		while (_used > _budget && !_lru.empty()) {
+			auto& victim = _lru.back();
+			if (victim == keep) break; //the only entry left is the one which was just requested
+			auto it = _entries.find(victim);
+			_used -= it->second.cost;
+			_entries.erase(it);
+			_lru.pop_back();
+		}
+	}
+
+	void DocumentCache::invalidate(std::string_view path) {
+		std::lock_guard lock(_mutex);
+		if (auto it = _entries.find(std::string(path)); it != _entries.end()) {
+			_used -= it->second.cost;
+			_lru.erase(it->second.lru);
+			_entries.erase(it);
+		}
+	}
+
+	void DocumentCache::clear() {
+		std::lock_guard lock(_mutex);
+		_entries.clear();
+		_lru.clear();
+		_used = 0;
+	}
+
+	size_t DocumentCache::memoryUsage() const {
+		std::lock_guard lock(_mutex);
+		return _used;
+	}
+}
@@ -0,0 +1,60 @@
+//
+//  infyJSON lib
+//
+#pragma once
+
+#include "Value.h"
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string_view>
+
+namespace JSON {
+
+	//Cache of parsed files for config hot-reload.
+	//File is parsed again only when its device, inode, modification time or size change, otherwise
+	//all callers share the same immutable document. Documents are evicted in LRU order when their
+	//estimated memory goes over the budget; evicted documents stay alive while someone holds them.
+	//Safe to use from several threads at once.
+	class DocumentCache {
+		struct FileStamp {
+			uint64_t device{ 0 };
+			uint64_t inode{ 0 };
+			int64_t modified{ 0 };
+			uint64_t size{ 0 };
+
+			bool operator==(const FileStamp& right) const;
+		};
+
+		struct Entry {
+			FileStamp stamp;
+			std::shared_ptr<const Value> document;
+			size_t cost{ 0 };
+			std::list<std::string>::iterator lru;
+		};
+
+		mutable std::mutex _mutex;
+		std::unordered_map<std::string, Entry> _entries;
+		std::list<std::string> _lru; //most recently used first
+		size_t _budget;
+		size_t _used{ 0 };
+
+		static std::optional<FileStamp> stamp(const std::string& path);
+		void evict(const std::string& keep);
+
+	public:
+		explicit DocumentCache(size_t memoryBudget = 64 * 1024 * 1024) : _budget{ memoryBudget } {}
+
+		DocumentCache(const DocumentCache&) = delete;
+		DocumentCache& operator=(const DocumentCache&) = delete;
+
+		//returns nullptr when file doesn't exist or isn't valid JSON
+		std::shared_ptr<const Value> get(std::string_view path);
+
+		void invalidate(std::string_view path);
+		void clear();
+		//estimated memory of cached documents in bytes
+		size_t memoryUsage() const;
+	};
+}
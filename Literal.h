@@ -0,0 +1,163 @@
+//
+//  infyJSON lib
+//
+#pragma once
+
+#include "Parser.h"
+#include <stdexcept>
+#include <string_view>
+
+//Validates JSON literal at compile time and parses it only once, on first evaluation.
+//Result is a read-only reference to Value with static storage duration:
+//  const JSON::Value& config = INFYJSON_LITERAL(R"({"threads": 4})");
+//Malformed literal is a compile error; the few errors only runtime parser sees (e.g. number out of range)
+//throw std::invalid_argument on first evaluation.
+#define INFYJSON_LITERAL(json) \
+	([]() -> const ::JSON::Value& { \
+		static_assert(::JSON::literals::isValid(json), "malformed JSON literal"); \
+		static const ::JSON::Value value = ::JSON::_literal::parse(json); \
+		return value; \
+	}())
+
+namespace JSON {
+
+	namespace _literal {
+
+		class Validator {
+			std::string_view _json;
+			std::size_t _pos{ 0 };
+
+			static constexpr std::size_t maxDepth = 512;
+
+			constexpr bool isEOF() const {
+				return _pos >= _json.size();
+			}
+
+			constexpr char peek() const {
+				return isEOF() ? '\0' : _json[_pos];
+			}
+
+			constexpr void skipSpaces() {
+				while (!isEOF() && (_json[_pos] == ' ' || _json[_pos] == '\t' || _json[_pos] == '\n' || _json[_pos] == '\r')) {
+					++_pos;
+				}
+			}
+
+			constexpr bool consume(char c) {
+				skipSpaces();
+				if (peek() != c) return false;
+				++_pos;
+				return true;
+			}
+
+			constexpr bool isDigit(char c) const {
+				return c >= '0' && c <= '9';
+			}
+
+			constexpr bool isHexDigit(char c) const {
+				return isDigit(c) || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+			}
+
+			//_pos is right after backslash
+			constexpr bool escape() {
+				if (isEOF()) return false;
+				char c = _json[_pos++];
+				if (c == 'u') {
+					for (int i = 0; i < 4; ++i, ++_pos) {
+						if (!isHexDigit(peek())) return false;
+					}
+					return true;
+				}
+				return c == '\"' || c == '\\' || c == '/' || c == 'b' || c == 'f' || c == 'n' || c == 'r' || c == 't';
+			}
+
+			constexpr bool word(std::string_view w) {
+				if (_json.substr(_pos, w.size()) != w) return false;
+				_pos += w.size();
+				return true;
+			}
+
+			constexpr bool string() {
+				if (!consume('\"')) return false;
+				while (!isEOF()) {
+					char c = _json[_pos++];
+					if (c >= '\x00' && c <= '\x1F') return false;
+					if (c == '\"') return true;
+					if (c == '\\' && !escape()) return false;
+				}
+				return false;
+			}
+
+			constexpr bool number() {
+				if (peek() == '-') ++_pos;
+				if (!isDigit(peek())) return false;
+				while (isDigit(peek())) ++_pos;
+				if (peek() == '.') {
+					++_pos;
+					if (!isDigit(peek())) return false;
+					while (isDigit(peek())) ++_pos;
+				}
+				if (peek() == 'e' || peek() == 'E') {
+					++_pos;
+					if (peek() == '+' || peek() == '-') ++_pos;
+					if (!isDigit(peek())) return false;
+					while (isDigit(peek())) ++_pos;
+				}
+				return true;
+			}
+
+			constexpr bool value(std::size_t depth) {
+				if (depth > maxDepth) return false;
+				skipSpaces();
+				switch (peek()) {
+				case '{':
+					++_pos;
+					if (consume('}')) return true;
+					do {
+						if (!string() || !consume(':') || !value(depth + 1)) return false;
+					} while (consume(','));
+					return consume('}');
+				case '[':
+					++_pos;
+					if (consume(']')) return true;
+					do {
+						if (!value(depth + 1)) return false;
+					} while (consume(','));
+					return consume(']');
+				case '\"':
+					return string();
+				case 't':
+					return word("true");
+				case 'f':
+					return word("false");
+				case 'n':
+					return word("null");
+				default:
+					return number();
+				}
+			}
+
+		public:
+			constexpr explicit Validator(std::string_view json) : _json{ json } {}
+
+			constexpr bool validate() {
+				if (!value(0)) return false;
+				skipSpaces();
+				return isEOF();
+			}
+		};
+
+		//runtime parser is stricter than Validator, so its failure still has to be reported
+		inline Value parse(std::string_view json) {
+			auto value = parseFromString(json);
+			if (!value) throw std::invalid_argument("malformed JSON literal: " + getLastError().toString());
+			return std::move(*value);
+		}
+	}
+
+	namespace literals {
+		constexpr bool isValid(std::string_view json) {
+			return _literal::Validator(json).validate();
+		}
+	}
+}
@@ -0,0 +1,329 @@
+//
+//  infyJSON lib
+//
+
+#include "ParallelParser.h"
+#include "Parser.h"
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <mutex>
+#include <thread>
+
+namespace JSON {
+
+	namespace {
+
+		//documents and containers smaller than that aren't worth splitting
+		constexpr size_t minParallelSize = 1 << 20;
+		constexpr size_t minSplitSize = 1 << 16;
+		constexpr int maxSplitDepth = 2;
+
+		struct Element {
+			const char* keyBegin{ nullptr };
+			const char* keyEnd{ nullptr };
+			const char* begin;
+			const char* end;
+		};
+
+		//either run of neighbour array elements, parsed together as one array and moved into their slots,
+		//or one object member; dest is nullptr for duplicate key, whose value is only validated
+		struct Job {
+			const char* begin;
+			const char* end;
+			std::vector<JValue>* run{ nullptr };
+			size_t first{ 0 };
+			JValue* dest{ nullptr };
+		};
+
+		bool isSpace(char c) {
+			return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+		}
+
+		const char* skipSpaces(const char* p, const char* last) {
+			while (p != last && isSpace(*p)) ++p;
+			return p;
+		}
+
+		//p points after opening quote, returns pointer to closing quote or nullptr
+		const char* findStringEnd(const char* p, const char* last) {
+			bool escaped = false;
+			for (; p != last; ++p) {
+				if (*p == '\\') {
+					escaped = !escaped;
+				} else if (*p == '\"' && !escaped) {
+					return p;
+				} else {
+					escaped = false;
+				}
+			}
+			return nullptr;
+		}
+
+		//returns end of value which starts at p; strings and nesting are tracked, nothing is parsed
+		const char* findValueEnd(const char* p, const char* last) {
+			if (p == last) return nullptr;
+			if (*p == '\"') {
+				const char* close = findStringEnd(p + 1, last);
+				return close ? close + 1 : nullptr;
+			}
+			if (*p != '[' && *p != '{') {
+				while (p != last && *p != ',' && *p != ']' && *p != '}' && !isSpace(*p)) ++p;
+				return p;
+			}
+			size_t depth = 0;
+			for (; p != last; ++p) {
+				char c = *p;
+				if (c == '\"') {
+					p = findStringEnd(p + 1, last);
+					if (!p) return nullptr;
+				} else if (c == '[' || c == '{') {
+					++depth;
+				} else if (c == ']' || c == '}') {
+					if (--depth == 0) return p + 1;
+				}
+			}
+			return nullptr;
+		}
+
+		//calls f for every direct element of container [begin, end), stops when f returns false
+		template<typename F>
+		bool forEachElement(const char* begin, const char* end, F&& f) {
+			bool isObject = *begin == '{';
+			char close = isObject ? '}' : ']';
+			const char* p = skipSpaces(begin + 1, end);
+			if (p != end && *p == close) return p + 1 == end;
+			while (p != end) {
+				Element element;
+				if (isObject) {
+					if (*p != '\"') return false;
+					element.keyBegin = p + 1;
+					element.keyEnd = findStringEnd(p + 1, end);
+					if (!element.keyEnd) return false;
+					for (const char* k = element.keyBegin; k != element.keyEnd; ++k) {
+						if (*k >= '\x00' && *k <= '\x1F') return false;
+					}
+					p = skipSpaces(element.keyEnd + 1, end);
+					if (p == end || *p != ':') return false;
+					p = skipSpaces(p + 1, end);
+				}
+				element.begin = p;
+				element.end = findValueEnd(p, end);
+				if (!element.end || element.end == element.begin || !f(element)) return false;
+				p = skipSpaces(element.end, end);
+				if (p == end) return false;
+				if (*p == close) return p + 1 == end;
+				if (*p != ',') return false;
+				p = skipSpaces(p + 1, end);
+			}
+			return false;
+		}
+
+		bool split(const char* begin, const char* end, std::vector<Element>& elements) {
+			return forEachElement(begin, end, [&elements](const Element& element) {
+				elements.push_back(element);
+				return true;
+			});
+		}
+
+		//JSON pointer of the element which starts at target, used only to report errors
+		std::string pathTo(const char* begin, const char* end, const char* target) {
+			std::string path;
+			while (begin != target && (*begin == '[' || *begin == '{')) {
+				std::vector<Element> elements;
+				split(begin, end, elements);
+				auto it = std::find_if(elements.begin(), elements.end(), [target](const Element& e) { return e.begin <= target && target < e.end; });
+				if (it == elements.end()) break;
+				path += '/';
+				if (it->keyBegin) {
+					for (const char* k = it->keyBegin; k != it->keyEnd; ++k) {
+						path += *k == '~' ? "~0" : *k == '/' ? "~1" : std::string(1, *k);
+					}
+				} else {
+					path += std::to_string(it - elements.begin());
+				}
+				begin = it->begin;
+				end = it->end;
+			}
+			return path;
+		}
+
+		bool isBigContainer(const char* begin, const char* end) {
+			return static_cast<size_t>(end - begin) >= minSplitSize && (*begin == '[' || *begin == '{');
+		}
+
+		//builds containers in dest and collects elements to be parsed. Element boxes are left empty, so their
+		//allocation happens on worker threads together with the rest of the element, and neighbour array
+		//elements are grouped in runs, so per element calling thread only scans structure and adds empty slot.
+		bool plan(const char* begin, const char* end, Value& dest, int depth, std::vector<Job>& jobs) {
+			auto splits = [depth](const Element& element) {
+				return depth < maxSplitDepth && isBigContainer(element.begin, element.end);
+			};
+			if (*begin == '[') {
+				auto& arr = dest.emplace<JArray>().value();
+				Job run{ nullptr, nullptr, &arr, 0, nullptr };
+				auto flush = [&jobs, &run]() {
+					if (run.begin) {
+						jobs.push_back(run);
+						run.begin = nullptr;
+					}
+				};
+				bool ok = forEachElement(begin, end, [&](const Element& element) {
+					if (splits(element)) {
+						flush();
+						return plan(element.begin, element.end, *arr.emplace_back(std::make_unique<Value>()), depth + 1, jobs);
+					}
+					if (!run.begin) {
+						run.begin = element.begin;
+						run.first = arr.size();
+					}
+					run.end = element.end;
+					arr.emplace_back(std::unique_ptr<Value>());
+					if (static_cast<size_t>(run.end - run.begin) >= minSplitSize) flush();
+					return true;
+				});
+				flush();
+				return ok;
+			}
+			auto& map = dest.emplace<JObject>();
+			return forEachElement(begin, end, [&](const Element& element) {
+				auto [it, inserted] = map->try_emplace(std::string(element.keyBegin, element.keyEnd), std::unique_ptr<Value>());
+				if (!inserted) { //first value wins, like in sequential parser, but the other one must be valid JSON too
+					jobs.push_back({ element.begin, element.end, nullptr, 0, nullptr });
+				} else if (splits(element)) {
+					it->second = JValue(std::make_unique<Value>());
+					return plan(element.begin, element.end, it->second.value(), depth + 1, jobs);
+				} else {
+					jobs.push_back({ element.begin, element.end, nullptr, 0, &it->second });
+				}
+				return true;
+			});
+		}
+
+		//parses one job on worker thread, error offset and path are relative to the job's first element
+		bool run(const Job& job, ParseError& error) {
+			std::string_view text(job.begin, static_cast<size_t>(job.end - job.begin));
+			if (!job.run) {
+				auto value = parseFromString(text);
+				if (!value) {
+					error = getLastError();
+					return false;
+				}
+				if (job.dest) {
+					*job.dest = JValue(std::make_unique<Value>(std::move(*value)));
+				}
+				return true;
+			}
+			std::string wrapped;
+			wrapped.reserve(text.size() + 2);
+			wrapped += '[';
+			wrapped += text;
+			wrapped += ']';
+			auto value = parseFromString(wrapped);
+			if (!value) {
+				//"/3/name" inside the run is "/<first + 3>/name" inside its array, empty path stays the array's one
+				error = getLastError();
+				error.offset = error.offset > 0 ? std::min(error.offset - 1, text.size()) : 0;
+				if (!error.path.empty()) {
+					size_t indexEnd = std::min(error.path.find('/', 1), error.path.size());
+					size_t local = std::stoul(error.path.substr(1, indexEnd - 1));
+					error.path = '/' + std::to_string(job.first + local) + error.path.substr(indexEnd);
+				}
+				return false;
+			}
+			auto& elements = value->getAs<JArray>().value();
+			for (size_t i = 0; i < elements.size(); ++i) {
+				(*job.run)[job.first + i] = std::move(elements[i]);
+			}
+			return true;
+		}
+	}
+
+	std::optional<Value> parseFromStringParallel(std::string_view jsonString, unsigned threads) {
+		if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+		const char* last = jsonString.data() + jsonString.size();
+		const char* begin = skipSpaces(jsonString.data(), last);
+		if (threads == 1 || jsonString.size() < minParallelSize || begin == last || (*begin != '[' && *begin != '{')) {
+			return parseFromString(jsonString);
+		}
+		//broken structure: sequential parser gives exact error
+		const char* end = findValueEnd(begin, last);
+		if (!end) return parseFromString(jsonString);
+
+		Value result;
+		std::vector<Job> jobs;
+		if (!plan(begin, end, result, 0, jobs)) return parseFromString(jsonString);
+
+		//neighbour elements are grouped into chunks, threads take next free chunk when they are done
+		size_t chunkBytes = std::max<size_t>(static_cast<size_t>(end - begin) / (threads * 16), 1);
+		std::vector<size_t> chunks{ 0 };
+		size_t bytes = 0;
+		for (size_t i = 0; i < jobs.size(); ++i) {
+			bytes += static_cast<size_t>(jobs[i].end - jobs[i].begin);
+			if (bytes >= chunkBytes) {
+				chunks.push_back(i + 1);
+				bytes = 0;
+			}
+		}
+		if (chunks.back() != jobs.size()) chunks.push_back(jobs.size());
+
+		std::atomic<size_t> nextChunk{ 0 };
+		std::atomic<bool> failed{ false };
+		std::mutex errorMutex;
+		size_t failedJob = jobs.size();
+		ParseError error;
+		auto worker = [&]() {
+			for (size_t chunk = nextChunk++; chunk + 1 < chunks.size() && !failed; chunk = nextChunk++) {
+				for (size_t i = chunks[chunk]; i < chunks[chunk + 1]; ++i) {
+					ParseError jobError;
+					if (!run(jobs[i], jobError)) {
+						std::lock_guard lock(errorMutex);
+						if (i < failedJob) { //report the first error in document order
+							failedJob = i;
+							error = std::move(jobError);
+						}
+						failed = true;
+						return;
+					}
+				}
+			}
+		};
+		std::vector<std::thread> pool;
+		unsigned poolSize = static_cast<unsigned>(std::min<size_t>(threads, chunks.size() - 1));
+		for (unsigned i = 1; i < poolSize; ++i) {
+			pool.emplace_back(worker);
+		}
+		worker();
+		for (auto& thread : pool) {
+			thread.join();
+		}
+		if (failed) {
+			const auto& job = jobs[failedJob];
+			std::string path = pathTo(begin, end, job.begin);
+			if (job.run) {
+				path.erase(path.rfind('/')); //run's path ends with index of its first element
+			}
+			error.offset += static_cast<size_t>(job.begin - jsonString.data());
+			error.path = path + error.path;
+			_parser::setLastError(jsonString, std::move(error));
+			return std::nullopt;
+		}
+		return std::optional{ std::move(result) };
+	}
+
+	std::optional<Value> parseFromFileParallel(std::string_view path, unsigned threads) {
+		std::ifstream input(std::string(path), std::ios::in | std::ios::binary | std::ios::ate);
+		std::streamoff size = input ? static_cast<std::streamoff>(input.tellg()) : 0;
+		if (size <= 0) { //missing, unreadable or empty file, like parseFromFile
+			ParseError error;
+			error.code = ErrorCode::FILE_ERROR;
+			_parser::setLastError(std::string_view(), std::move(error));
+			return std::nullopt;
+		}
+		auto length = static_cast<size_t>(size);
+		std::string buffer(length, '\0');
+		input.seekg(0, std::ios::beg);
+		input.read(buffer.data(), static_cast<std::streamsize>(length));
+		return parseFromStringParallel(buffer, threads);
+	}
+}
@@ -0,0 +1,18 @@
+//
+//  infyJSON lib
+//
+#pragma once
+
+#include "Value.h"
+#include <optional>
+#include <string_view>
+
+namespace JSON {
+
+	//Parses large document on several threads. Root array (and root object, and big arrays inside it)
+	//is split into elements by quick structural scan, elements are parsed concurrently and put
+	//back in original order. Small documents are parsed on the calling thread.
+	//threads == 0 means std::thread::hardware_concurrency().
+	std::optional<Value> parseFromStringParallel(std::string_view jsonString, unsigned threads = 0);
+	std::optional<Value> parseFromFileParallel(std::string_view path, unsigned threads = 0);
+}
@@ -3,71 +3,75 @@
 //
 
 #include "Parser.h"
+#include "Schema.h"
 #include <fstream>
-#include <charconv>
 #include <algorithm>
-#include <cctype>
-
-#define GET_NEXT(var) if (_parser::isEOF()) return 0; var = _parser::get()
-#define GET_NEXT_NON_SPACE(var) if (_parser::isEOF()) return 0; var = getFirstNonSpaceChar()
 
 namespace JSON {
 
-	namespace {
-		constexpr char tab = '\t';
-		constexpr char space = ' ';
-	}
-
 	namespace _parser {
 
-		enum BasicValue {
-			STRING,
-			NUMBER
-		};
-
-		std::unique_ptr<char[]> _buf;
-		const char* _pos;
-		const char* _last;
-		bool _eof;
-		std::string _lastReadLine;
-		size_t _lineNumber;
+		thread_local std::unique_ptr<char[]> _buf;
+		thread_local ErrorCode _errorCode;
+		thread_local const char* _errorPos;
+		thread_local std::vector<std::string> _errorPath; //filled in reverse order while failed reads unwind
+		thread_local ParseError _lastError;
+
+		void reset(const char* begin, const char* last) {
+			_begin = begin;
+			_pos = begin;
+			_last = last;
+			_eof = begin == last;
+			_errorCode = ErrorCode::NONE;
+			_errorPath.clear();
+		}
 
 		void init(std::string_view path) {
-			_lineNumber = 1;
-#ifdef INFYJSON_DEBUG
-			_lastReadLine.clear();
-#endif
 			std::ifstream input(std::string(path), std::ios::in | std::ios::binary | std::ios::ate);
-			unsigned int length = static_cast<unsigned int>(input.tellg());
+			unsigned int length = input ? static_cast<unsigned int>(input.tellg()) : 0;
 			if (length != 0) {
-				_buf = std::unique_ptr<char[]>(new char[length]);
-				_pos = _buf.get();
-				_last = _buf.get() + length;
+				_buf = std::unique_ptr<char[]>(new char[length + 1]);
+				_buf[length] = '\0';
+				reset(_buf.get(), _buf.get() + length);
 				input.seekg(0, std::ios::beg);
 				input.read(_buf.get(), length);
-				_eof = false;
 			} else {
 				_eof = true;
 			}
 			input.close();
 		}
 
-		char get() {
-			auto c = *_pos;
-			++_pos;
-#ifdef INFYJSON_DEBUG
-			_lastReadLine.push_back(c);
-			if (c == '\n') {
-				_lastReadLine.clear();
-				++_lineNumber;
+		void freeBuffer() {
+			_buf.reset();
+		}
+
+		//remembers the first error only, everything else is a consequence of it
+		int fail(ErrorCode code, const char* where) {
+			if (_errorCode == ErrorCode::NONE) {
+				_errorCode = code;
+				_errorPos = std::min(where, _last);
 			}
-#endif
-			_eof = (_pos == _last);
-			return c;
+			return 0;
 		}
 
-		bool isEOF() {
-			return _eof;
+		void addErrorPath(std::string segment) {
+			_errorPath.push_back(std::move(segment));
+		}
+
+		//_pos points after '/', returns false if it doesn't start a comment
+		bool skipComment() {
+			if (_pos == _last || (*_pos != '/' && *_pos != '*')) return false;
+			bool isLine = *_pos == '/';
+			std::string_view rest(_pos + 1, static_cast<size_t>(_last - _pos - 1));
+			size_t end = isLine ? rest.find('\n') : rest.find("*/");
+			if (end == std::string_view::npos) {
+				if (!isLine) fail(ErrorCode::UNEXPECTED_END, _pos - 1);
+				_pos = _last;
+			} else {
+				_pos = rest.data() + end + (isLine ? 0 : 2);
+			}
+			_eof = _pos == _last;
+			return true;
 		}
 
 		class LastQuoteFinder {
@@ -99,20 +103,26 @@ namespace JSON {
 				};
 				const char* v2 = std::find_if(v1, _last, search);
 
-				if (v2 + 1 == _last || v2 == _last) { // so, json which contains only string without last quote won't crash programm
+				if (v2 == _last) { // string without last quote
+					_eof = true;
+					_pos = _last;
+					fail(ErrorCode::UNEXPECTED_END);
+					return std::pair<const char*, const char*>(nullptr, nullptr);
+				}
+				if (v2 + 1 == _last) {
 					_eof = true;
 				}
 				_pos = v2 + 1;
-#ifdef INFYJSON_DEBUG
-				_lastReadLine.append(v1, v2);
-#endif
+				if (isBadChar) {
+					fail(ErrorCode::INVALID_STRING, std::find_if(v1, v2, [](const char c) { return c >= '\x00' && c <= '\x1F'; }));
+				}
 				return isBadChar ? std::pair<const char*, const char*>(nullptr, nullptr) : std::pair(v1, v2);
 			}
 			case BasicValue::NUMBER:
 			{
 				const char* v1 = _pos;
 				const char* v2 = std::find_if_not(v1, _last, [&hasFloatingPoint](const char c) {
-					if (c == '.') {
+					if (c == '.' || c == 'e' || c == 'E') {
 						hasFloatingPoint = true;
 						return true;
 					}
@@ -123,9 +133,6 @@ namespace JSON {
 				}
 				_pos = v2;
 				--v1; // to include first digit or '-'
-#ifdef INFYJSON_DEBUG
-				_lastReadLine.append(v1, v2);
-#endif
 				return std::pair(v1, v2);
 			}
 			default:
@@ -133,32 +140,70 @@ namespace JSON {
 			}
 		}
 
-		std::string getLastReadLine() {
-			using namespace std::string_literals;
-			return "Last parsed line("s + std::to_string(_lineNumber) + "): "s + _lastReadLine;
+		//installs schema for one parse on this thread, previous one is restored even if the parse throws
+		class SchemaScope {
+			const Schema* _oldValidator;
+			const _schema::Node* _oldNode;
+		public:
+			explicit SchemaScope(const Schema& schema) : _oldValidator(_validator), _oldNode(_schemaNode) {
+				_validator = &schema;
+				_schemaNode = schema.root();
+			}
+			~SchemaScope() {
+				_validator = _oldValidator;
+				_schemaNode = _oldNode;
+			}
+			SchemaScope(const SchemaScope&) = delete;
+			SchemaScope& operator=(const SchemaScope&) = delete;
+		};
+
+		bool schemaAcceptsObject() {
+			return !_validator || _validator->accepts(_schemaNode, _schema::OBJECT);
 		}
 
-	}
+		bool schemaAcceptsArray() {
+			return !_validator || _validator->accepts(_schemaNode, _schema::ARRAY);
+		}
 
-	namespace {
+		const _schema::Node* schemaProperty(const _schema::Node* node, const std::string& key) {
+			return _validator->property(node, key);
+		}
 
-		bool isSpaceChar(char c) 
-		{ 
-			return (c == tab || c == space); 
+		const _schema::Node* schemaItem(const _schema::Node* node, size_t index) {
+			return _validator->item(node, index);
 		}
 
-		bool isNewLineChar(char c) 
-		{ 
-			return (c == '\n' || c == '\r'); 
+		bool schemaCheck(const Value& o) {
+			return !_validator || _validator->check(_schemaNode, o) || fail(ErrorCode::SCHEMA_MISMATCH);
 		}
 
-		char getFirstNonSpaceChar() {
-			char c = _parser::get();
-			while ((isSpaceChar(c) || isNewLineChar(c)) && !_parser::isEOF())
-			{
-				c = _parser::get();
+		//line, column and context are computed only here, so successful parse doesn't pay for them
+		void setLastError(std::string_view text, ParseError error) {
+			size_t offset = std::min(error.offset, text.size());
+			size_t lineStart = 0;
+			if (offset > 0) {
+				size_t newLine = text.rfind('\n', offset - 1);
+				lineStart = newLine == std::string_view::npos ? 0 : newLine + 1;
+			}
+			size_t lineEnd = text.find_first_of("\r\n", offset);
+			if (lineEnd == std::string_view::npos) lineEnd = text.size();
+			error.line = 1 + static_cast<size_t>(std::count(text.begin(), text.begin() + lineStart, '\n'));
+			error.column = offset - lineStart + 1;
+			size_t contextBegin = std::max(lineStart, offset > 32 ? offset - 32 : 0);
+			size_t contextEnd = std::min(lineEnd, offset + 32);
+			error.context = std::string(text.substr(contextBegin, contextEnd > contextBegin ? contextEnd - contextBegin : 0));
+			_lastError = std::move(error);
+		}
+
+		void finishError() {
+			ParseError error;
+			error.code = _errorCode == ErrorCode::NONE ? ErrorCode::UNEXPECTED_CHARACTER : _errorCode;
+			error.offset = static_cast<size_t>((_errorCode == ErrorCode::NONE ? _pos : _errorPos) - _begin);
+			for (auto it = _errorPath.rbegin(); it != _errorPath.rend(); ++it) {
+				error.path += '/';
+				error.path += *it;
 			}
-			return c;
+			setLastError(std::string_view(_begin, static_cast<size_t>(_last - _begin)), std::move(error));
 		}
 
 		//legacy hex to int
@@ -209,54 +254,25 @@ namespace JSON {
 		}*/
 
 
-		bool isWord(char c, Value& o)
-		{
-			std::string s;
-			if (c == 'n' || c == 't') {
-				s += c;
-				for (int i = 0; i < 3; i++) {
-					GET_NEXT(c); //safe since nothing else starts with 'n' or 't'
-					s += c;
-				}
-				if (s == "null") {
-					return true;
-				}
-				if (s == "true") {
-					o = true;
-					return true;
-				}
-				return false;
-			} else if (c == 'f') {
-				s += c;
-				for (int i = 0; i < 4; i++) {
-					GET_NEXT(c);
-					s += c;
-				}
-				if (s == "false") {
-					o = false;
-					return true;
-				}
-				return false;
-			}
-			return false;
+		//space is returned only at the end of input, '\0' past the end comes from padding
+		int unexpected(char c) {
+			bool isEnd = isSpaceChar(c) || isNewLineChar(c) || _pos > _last;
+			return fail(isEnd ? ErrorCode::UNEXPECTED_END : ErrorCode::UNEXPECTED_CHARACTER, _pos - 1);
 		}
 
-		bool isNumber(char c, Value& o)
-		{	
-			if (std::isdigit(c) || c == '-') {
-				bool hasPoint = false;
-				auto range = _parser::getBasicValueBorders(_parser::NUMBER, hasPoint);
-				std::from_chars_result res;
-				if (hasPoint) {
-					auto& number = o.emplace<JNumber>(0.0).value();
-					res = std::from_chars(range.first, range.second, number);
+		//JSON pointer token for error path
+		std::string escapeKey(const std::string& key) {
+			std::string result;
+			for (char c : key) {
+				if (c == '~') {
+					result += "~0";
+				} else if (c == '/') {
+					result += "~1";
 				} else {
-					auto& number = o.emplace<JNumber>(0).value();
-					res = std::from_chars(range.first, range.second, number);
+					result += c;
 				}
-				return res.ptr == range.second;
 			}
-			return false;
+			return result;
 		}
 
 		//legacy escaped
@@ -316,7 +332,7 @@ namespace JSON {
 		{
 			if (c != '\"') return false;
 			bool dummy; //it's ok that it's uninitialized
-			auto range = _parser::getBasicValueBorders(_parser::STRING, dummy);
+			auto range = getBasicValueBorders(STRING, dummy);
 			if (range.first) {
 				std::string str(range.first, range.second);
 				o.emplace<JString>(std::move(str));
@@ -324,157 +340,78 @@ namespace JSON {
 			}
 			return false;	
 		}
+	}
 
-		int readKeyValue(char c, JObject& map);
-
-		int readMap(Value& o)
-		{
-			auto& map = o.emplace<JObject>();
-			GET_NEXT_NON_SPACE(char c);
-
-			if (c == '}') { //empty map
-				return 1;
-			}
-
-			while (true)
-			{
-				int res = readKeyValue(c, map);
-				if (res != 1) return res;
-
-				GET_NEXT_NON_SPACE(c); //  
-				if (c == '}') {
-					return 1;
-				} else if (c != ',') {
-					return 0;
-				}
-				GET_NEXT_NON_SPACE(c);
-			}
-		}
-
-		int readArray(Value& o)
-		{
-			auto& arr = o.emplace<JArray>();
-
-			GET_NEXT_NON_SPACE(char c);
-
-			if (c == ']') {
-				return 1;
-			}
-
-			while (true)
-			{
-				int codeRes = 0;
-				auto& temp = *arr->emplace_back();
-				switch (c)
-				{
-				case '{':
-					codeRes = readMap(temp);
-					break;
-				case '[':
-					codeRes = readArray(temp);
-					break;
-				default:
-					if (isString(c, temp) || isWord(c, temp) || isNumber(c, temp)) codeRes = 1;
-					break;
-				}
-				if (codeRes != 1) return 0;
-
-				GET_NEXT_NON_SPACE(c); //  
-				if (c == ']') {
-					arr->shrink_to_fit();
-					return 1;
-				} else if (c != ',') {
-					return 0;
-				}
-				GET_NEXT_NON_SPACE(c);
-			}
-		}
-
-		int readKeyValue(char c, JObject& map)
-		{
-			Value key, o;
-
-			if (!isString(c, key)) return 0;
-
-			GET_NEXT_NON_SPACE(c);
-			if (c != ':') return 0;
-
+	template std::optional<Value> parseFromFile<DefaultPolicy>(std::string_view path);
+	template std::optional<Value> parseFromString<DefaultPolicy>(std::string_view jsonString);
+	template std::optional<Value> parseFromString<DefaultPolicy>(const std::string& jsonString);
+	template std::optional<Value> parseFromString<DefaultPolicy>(const char* jsonString);
+	template std::optional<Value> parseFromFile<StrictPolicy>(std::string_view path);
+	template std::optional<Value> parseFromString<StrictPolicy>(std::string_view jsonString);
+	template std::optional<Value> parseFromString<StrictPolicy>(const std::string& jsonString);
+	template std::optional<Value> parseFromString<StrictPolicy>(const char* jsonString);
+	template std::optional<Value> parseFromFile<LenientPolicy>(std::string_view path);
+	template std::optional<Value> parseFromString<LenientPolicy>(std::string_view jsonString);
+	template std::optional<Value> parseFromString<LenientPolicy>(const std::string& jsonString);
+	template std::optional<Value> parseFromString<LenientPolicy>(const char* jsonString);
+	template std::optional<Value> parseFromFile<PackedPolicy>(std::string_view path);
+	template std::optional<Value> parseFromString<PackedPolicy>(std::string_view jsonString);
+	template std::optional<Value> parseFromString<PackedPolicy>(const std::string& jsonString);
+	template std::optional<Value> parseFromString<PackedPolicy>(const char* jsonString);
+	template std::optional<Value> parseFromFile<PaddedPolicy>(std::string_view path);
+	template std::optional<Value> parseFromString<PaddedPolicy>(std::string_view jsonString);
+	template std::optional<Value> parseFromString<PaddedPolicy>(const std::string& jsonString);
+	template std::optional<Value> parseFromString<PaddedPolicy>(const char* jsonString);
 
-			GET_NEXT_NON_SPACE(c); 
-			int res = 0;
-			if (c == '{') {
-				res = readMap(o);	
-			} else if (c == '[') {
-				res = readArray(o);
-			} else if (isString(c, o) || isWord(c, o) || isNumber(c, o)) {
-				res = 1;
-			}
-
-			map->try_emplace(std::move(*key.getAs<JString>()), std::move(o));
-			return res;
-		}
+	std::optional<Value> parseFromFile(std::string_view path) {
+		return parseFromFile<DefaultPolicy>(path);
 	}
 
-	std::pair<JSON::Value, int> parse() {
-		std::pair<JSON::Value, int> p;
-		char c = getFirstNonSpaceChar();
-		int code = 0;
-		switch (c)
-		{
-		case '{':
-			code = readMap(p.first);
-			break;
-		case '[':
-			code = readArray(p.first);
-			break;
-		default:
-			if (isString(c, p.first) || isWord(c, p.first) || isNumber(c, p.first)) code = 1;
-			break;
-		}
-		p.second = code;
-		return p;
+	std::optional<Value> parseFromString(std::string_view jsonString) {
+		return parseFromString<DefaultPolicy>(jsonString);
 	}
 
-	std::optional<Value> parseFromFile(std::string_view path) {
+	std::optional<Value> parseFromFile(std::string_view path, const Schema& schema) {
+		_parser::SchemaScope scope(schema);
+		return parseFromFile(path);
+	}
 
-		_parser::init(path);
+	std::optional<Value> parseFromString(std::string_view jsonString, const Schema& schema) {
+		_parser::SchemaScope scope(schema);
+		return parseFromString(jsonString);
+	}
 
-		if (_parser::isEOF()) { //empty file case
-			return std::nullopt;
-		}
+	std::optional<Value> parseFromFile(std::string_view path, ParseError& error) {
+		auto result = parseFromFile(path);
+		error = result ? ParseError() : _parser::_lastError;
+		return result;
+	}
 
-		auto [val, code] = parse();
+	std::optional<Value> parseFromString(std::string_view jsonString, ParseError& error) {
+		auto result = parseFromString(jsonString);
+		error = result ? ParseError() : _parser::_lastError;
+		return result;
+	}
 
-		_parser::_buf.reset();
-		if (code == 1) return std::optional{std::move(val)};
-		return std::nullopt;
+	const ParseError& getLastError() {
+		return _parser::_lastError;
 	}
 
-	std::optional<Value> parseFromString(std::string_view jsonString) {
-		if (jsonString.size() > 0) {
-			_parser::_eof = false;
-			_parser::_pos = jsonString.data();
-			_parser::_last = jsonString.data() + jsonString.size();
-			auto[val, code] = parse();
-			if (code == 1) return std::optional{ std::move(val) };
-		}
-		return std::nullopt;
+	std::string ParseError::toString() const {
+		static const char* names[] = { "no error", "empty input", "can't read file", "unexpected end of input", "unexpected character",
+			"invalid string", "invalid number", "invalid literal", "value doesn't match schema", "duplicate key", "nesting is too deep" };
+		using namespace std::string_literals;
+		return names[static_cast<int>(code)] + " at line "s + std::to_string(line) + ", column "s + std::to_string(column)
+			+ " (offset "s + std::to_string(offset) + "), path \""s + path + "\": "s + context;
 	}
 
 	std::string getDebugInfo() {
-		return _parser::getLastReadLine();
+		return _parser::_lastError.toString();
 	}
 
 	namespace literals {
 		std::optional<Value> operator"" _json(const char * json, std::size_t size) {
-			if (size > 0) {
-				_parser::_eof = false;
-				_parser::_pos = json;
-				_parser::_last = json + size;
-				auto[val, code] = parse();
-				if (code == 1) return std::optional{std::move(val)};
-			}
-			return std::nullopt;
+			return parseFromString(std::string_view(json, size));
 		}
 	}
 }
\ No newline at end of file
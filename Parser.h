@@ -9,12 +9,105 @@
 
 namespace JSON {
 
+	enum class ErrorCode {
+		NONE,
+		EMPTY_INPUT,
+		FILE_ERROR,
+		UNEXPECTED_END,
+		UNEXPECTED_CHARACTER,
+		INVALID_STRING,
+		INVALID_NUMBER,
+		INVALID_LITERAL,
+		SCHEMA_MISMATCH,
+		DUPLICATE_KEY,
+		TOO_DEEP
+	};
+
+	enum class DuplicateKeys {
+		KEEP_FIRST,
+		KEEP_LAST,
+		REJECT
+	};
+
+	enum class NumberMode {
+		AUTO, //int64_t unless number has '.' or exponent
+		DOUBLE //every number is double
+	};
+
+	//Compile-time parser options. Derive from DefaultPolicy and override what you need,
+	//every parser instantiation contains only the checks its policy asks for.
+	struct DefaultPolicy {
+		//number of '\0' bytes guaranteed to follow input; with at least one of them parser doesn't check for the end of input,
+		//truncated input still fails safely
+		static constexpr size_t padding = 0;
+		static constexpr bool comments = false; // "//" and "/* */"
+		static constexpr bool trailingCommas = false;
+		static constexpr DuplicateKeys duplicateKeys = DuplicateKeys::KEEP_FIRST;
+		static constexpr size_t maxDepth = 0; //0 means unlimited
+		static constexpr NumberMode numbers = NumberMode::AUTO;
+		//arrays of numbers of one type become contiguous JIntArray/JDoubleArray, not used while validating schema
+		static constexpr bool packNumbers = false;
+	};
+
+	struct StrictPolicy : DefaultPolicy {
+		static constexpr DuplicateKeys duplicateKeys = DuplicateKeys::REJECT;
+		static constexpr size_t maxDepth = 512;
+	};
+
+	struct LenientPolicy : DefaultPolicy {
+		static constexpr bool comments = true;
+		static constexpr bool trailingCommas = true;
+		static constexpr DuplicateKeys duplicateKeys = DuplicateKeys::KEEP_LAST;
+	};
+
+	struct PackedPolicy : DefaultPolicy {
+		static constexpr bool packNumbers = true;
+	};
+
+	//for std::string_view input which is known to be followed by '\0', e.g. a view into bigger buffer;
+	//std::string and C strings get padded parsing with any policy
+	struct PaddedPolicy : DefaultPolicy {
+		static constexpr size_t padding = 1;
+	};
+
+	struct ParseError {
+		ErrorCode code{ ErrorCode::NONE };
+		size_t offset{ 0 }; //in bytes from the beginning of input
+		size_t line{ 0 };
+		size_t column{ 0 }; //in bytes, both line and column start from 1
+		std::string context; //part of the line around offset
+		std::string path; //JSON pointer to the value which failed, e.g. "/servers/2/port"
+		std::string toString() const;
+	};
+
+	std::optional<Value> parseFromFile(std::string_view path);
+	std::optional<Value> parseFromString(std::string_view jsonString);
+	std::optional<Value> parseFromFile(std::string_view path, ParseError& error);
+	std::optional<Value> parseFromString(std::string_view jsonString, ParseError& error);
+	//defined in ParserImpl.h, so any policy works; files are always read into padded buffer
+	template<typename Policy>
 	std::optional<Value> parseFromFile(std::string_view path);
+	//with padded policy '\0' must follow jsonString.data() + size(), debug builds assert it
+	template<typename Policy>
 	std::optional<Value> parseFromString(std::string_view jsonString);
+	//std::string and C strings always end with '\0', so they are parsed as padded whatever policy says
+	template<typename Policy>
+	std::optional<Value> parseFromString(const std::string& jsonString);
+	template<typename Policy>
+	std::optional<Value> parseFromString(const char* jsonString);
+	//error of the last failed parse on this thread
+	const ParseError& getLastError();
 	std::string getDebugInfo();
 
+	namespace _parser {
+		//fills line, column and context of error from its offset in text and makes it the last error
+		void setLastError(std::string_view text, ParseError error);
+	}
+
 	namespace literals {
 		std::optional<Value> operator"" _json(const char * json, std::size_t size);
 	}
 }
 
+#include "ParserImpl.h"
+
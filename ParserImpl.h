@@ -0,0 +1,473 @@
+//
+//  infyJSON lib
+//
+#pragma once
+
+//Parser templates, included by Parser.h so the parser is instantiated for any policy.
+//Built-in policies are instantiated once in Parser.cpp.
+
+#include <cassert>
+#include <charconv>
+#include <cctype>
+#include <memory>
+
+#define GET_NEXT(var) if (_parser::isEOF<Policy>()) return _parser::fail(ErrorCode::UNEXPECTED_END); var = _parser::get<Policy>()
+#define GET_NEXT_NON_SPACE(var) if (_parser::isEOF<Policy>()) return _parser::fail(ErrorCode::UNEXPECTED_END); var = getFirstNonSpaceChar<Policy>()
+
+namespace JSON {
+
+	class Schema;
+
+	namespace _schema {
+		struct Node;
+	}
+
+	namespace _parser {
+
+		constexpr char tab = '\t';
+		constexpr char space = ' ';
+
+		enum BasicValue {
+			STRING,
+			NUMBER
+		};
+
+		inline thread_local const char* _begin;
+		inline thread_local const char* _pos;
+		inline thread_local const char* _last;
+		inline thread_local bool _eof;
+		inline thread_local const Schema* _validator = nullptr;
+		inline thread_local const _schema::Node* _schemaNode = nullptr;
+
+		//file buffer always ends with '\0', so files are read without bounds checks whatever policy says
+		template<typename Policy>
+		struct Padded : Policy {
+			static constexpr size_t padding = 1;
+		};
+
+		//defined in Parser.cpp
+		void reset(const char* begin, const char* last);
+		void init(std::string_view path);
+		void freeBuffer();
+		int fail(ErrorCode code, const char* where = _pos);
+		void addErrorPath(std::string segment);
+		bool skipComment();
+		std::pair<const char*, const char*> getBasicValueBorders(BasicValue val, bool& hasFloatingPoint);
+		int unexpected(char c);
+		std::string escapeKey(const std::string& key);
+		bool isString(char c, Value& o);
+		void finishError();
+
+		//schema hooks, Schema.h isn't needed here
+		bool schemaAcceptsObject();
+		bool schemaAcceptsArray();
+		const _schema::Node* schemaProperty(const _schema::Node* node, const std::string& key);
+		const _schema::Node* schemaItem(const _schema::Node* node, size_t index);
+		bool schemaCheck(const Value& o);
+
+		//with padded input '\0' after the last char stops every scan, so there is nothing to check
+		template<typename Policy>
+		char get() {
+			if constexpr (Policy::padding > 0) {
+				return *_pos++;
+			} else {
+				auto c = *_pos;
+				++_pos;
+				_eof = (_pos == _last);
+				return c;
+			}
+		}
+
+		template<typename Policy>
+		bool isEOF() {
+			if constexpr (Policy::padding > 0) {
+				return false;
+			} else {
+				return _eof;
+			}
+		}
+
+		inline bool isSpaceChar(char c) 
+		{ 
+			return (c == tab || c == space); 
+		}
+
+		inline bool isNewLineChar(char c) 
+		{ 
+			return (c == '\n' || c == '\r'); 
+		}
+
+		template<typename Policy>
+		char getFirstNonSpaceChar() {
+			char c = get<Policy>();
+			while (true) {
+				while ((isSpaceChar(c) || isNewLineChar(c)) && !isEOF<Policy>())
+				{
+					c = get<Policy>();
+				}
+				if constexpr (Policy::comments) {
+					if (c == '/' && skipComment()) {
+						if (isEOF<Policy>()) return space;
+						c = get<Policy>();
+						continue;
+					}
+				}
+				return c;
+			}
+		}
+
+		template<typename Policy>
+		bool isWord(char c, Value& o)
+		{
+			std::string_view word = c == 'n' ? "null" : c == 't' ? "true" : c == 'f' ? "false" : "";
+			if (word.empty()) return false;
+			const char* begin = _pos - 1;
+			for (char expected : word.substr(1)) {
+				GET_NEXT(c); //safe since nothing else starts with 'n', 't' or 'f'
+				if (c != expected) { //stops at padding, so no more than one char past the end is read
+					return _pos > _last ? fail(ErrorCode::UNEXPECTED_END, _last)
+						: fail(ErrorCode::INVALID_LITERAL, begin);
+				}
+			}
+			if (word[0] != 'n') {
+				o = word[0] == 't';
+			}
+			return true;
+		}
+
+		template<typename Policy>
+		bool isNumber(char c, Value& o)
+		{	
+			if (std::isdigit(c) || c == '-') {
+				bool hasPoint = false;
+				auto range = getBasicValueBorders(NUMBER, hasPoint);
+				std::from_chars_result res;
+				if (Policy::numbers == NumberMode::DOUBLE || hasPoint) {
+					auto& number = o.emplace<JNumber>(0.0).value();
+					res = std::from_chars(range.first, range.second, number);
+				} else {
+					auto& number = o.emplace<JNumber>(0).value();
+					res = std::from_chars(range.first, range.second, number);
+				}
+				//out of range numbers (e.g. integer above int64_t) are errors, not zero
+				return (res.ec == std::errc() && res.ptr == range.second) || fail(ErrorCode::INVALID_NUMBER, range.first);
+			}
+			return false;
+		}
+
+		template<typename Policy>
+		int readKeyValue(char c, JObject& map, size_t depth);
+
+		template<typename Policy>
+		int tooDeep(size_t depth) {
+			if constexpr (Policy::maxDepth > 0) {
+				if (depth > Policy::maxDepth) return fail(ErrorCode::TOO_DEEP, _pos - 1);
+			}
+			return 1;
+		}
+
+		template<typename Policy>
+		int readMap(Value& o, size_t depth)
+		{
+			if (!tooDeep<Policy>(depth)) return 0;
+			if (!schemaAcceptsObject()) return 0;
+			auto& map = o.emplace<JObject>();
+			GET_NEXT_NON_SPACE(char c);
+
+			if (c == '}') { //empty map
+				return 1;
+			}
+
+			while (true)
+			{
+				int res = readKeyValue<Policy>(c, map, depth);
+				if (res != 1) return res;
+
+				GET_NEXT_NON_SPACE(c); //  
+				if (c == '}') {
+					return 1;
+				} else if (c != ',') {
+					return unexpected(c);
+				}
+				GET_NEXT_NON_SPACE(c);
+				if constexpr (Policy::trailingCommas) {
+					if (c == '}') return 1;
+				}
+			}
+		}
+
+		template<typename T>
+		struct PackedArray;
+		template<>
+		struct PackedArray<int64_t> { using type = JIntArray; };
+		template<>
+		struct PackedArray<double> { using type = JDoubleArray; };
+
+		//reads numbers of type T straight into contiguous vector; returns -1 with c at the first element
+		//which isn't such number, in that case numbers read so far are moved to arr as general elements
+		template<typename Policy, typename T>
+		int readNumbers(char& c, Value& o, JArray& arr)
+		{
+			std::vector<T> numbers;
+			while (std::isdigit(c) || c == '-') {
+				const char* pos = _pos;
+				bool eof = _eof;
+				bool hasPoint = false;
+				auto range = getBasicValueBorders(NUMBER, hasPoint);
+				if ((Policy::numbers == NumberMode::DOUBLE || hasPoint) != std::is_same_v<T, double>) {
+					_pos = pos;
+					_eof = eof;
+					break;
+				}
+				T number{};
+				auto res = std::from_chars(range.first, range.second, number);
+				if (res.ec != std::errc() || res.ptr != range.second) {
+					addErrorPath(std::to_string(numbers.size()));
+					return fail(ErrorCode::INVALID_NUMBER, range.first);
+				}
+				numbers.push_back(number);
+
+				GET_NEXT_NON_SPACE(c);
+				bool isLast = c == ']';
+				if (!isLast) {
+					if (c != ',') return unexpected(c);
+					GET_NEXT_NON_SPACE(c);
+					if constexpr (Policy::trailingCommas) {
+						isLast = c == ']';
+					}
+				}
+				if (isLast) {
+					numbers.shrink_to_fit();
+					o.emplace<typename PackedArray<T>::type>(std::move(numbers));
+					return 1;
+				}
+			}
+			arr->reserve(numbers.size() + 1);
+			for (T number : numbers) {
+				arr->emplace_back(number);
+			}
+			return -1;
+		}
+
+		template<typename Policy>
+		int readArray(Value& o, size_t depth)
+		{
+			if (!tooDeep<Policy>(depth)) return 0;
+			if (!schemaAcceptsArray()) return 0;
+			auto& arr = o.emplace<JArray>();
+
+			GET_NEXT_NON_SPACE(char c);
+
+			if (c == ']') {
+				return 1;
+			}
+
+			if constexpr (Policy::packNumbers) {
+				if (!_validator) {
+					int res = readNumbers<Policy, int64_t>(c, o, arr);
+					if (res == -1 && arr->empty()) res = readNumbers<Policy, double>(c, o, arr);
+					if (res != -1) return res;
+				}
+			}
+
+			while (true)
+			{
+				int codeRes = 0;
+				auto& temp = *arr->emplace_back();
+				auto parentNode = _schemaNode;
+				if (_validator) {
+					_schemaNode = schemaItem(parentNode, arr->size() - 1);
+				}
+				switch (c)
+				{
+				case '{':
+					codeRes = readMap<Policy>(temp, depth + 1);
+					break;
+				case '[':
+					codeRes = readArray<Policy>(temp, depth + 1);
+					break;
+				default:
+					if (isString(c, temp) || isWord<Policy>(c, temp) || isNumber<Policy>(c, temp)) {
+						codeRes = 1;
+					} else {
+						unexpected(c);
+					}
+					break;
+				}
+				if (codeRes == 1 && !schemaCheck(temp)) codeRes = 0;
+				_schemaNode = parentNode;
+				if (codeRes != 1) {
+					addErrorPath(std::to_string(arr->size() - 1));
+					return 0;
+				}
+
+				GET_NEXT_NON_SPACE(c); //  
+				if (c == ']') {
+					arr->shrink_to_fit();
+					return 1;
+				} else if (c != ',') {
+					return unexpected(c);
+				}
+				GET_NEXT_NON_SPACE(c);
+				if constexpr (Policy::trailingCommas) {
+					if (c == ']') {
+						arr->shrink_to_fit();
+						return 1;
+					}
+				}
+			}
+		}
+
+		template<typename Policy>
+		int readKeyValue(char c, JObject& map, size_t depth)
+		{
+			Value key, o;
+
+			const char* keyBegin = _pos - 1;
+			if (!isString(c, key)) return c == '\"' ? 0 : unexpected(c);
+			if constexpr (Policy::duplicateKeys == DuplicateKeys::REJECT) {
+				if (map->count(key.getAs<std::string>()) != 0) {
+					addErrorPath(escapeKey(key.getAs<std::string>()));
+					return fail(ErrorCode::DUPLICATE_KEY, keyBegin);
+				}
+			}
+			auto parentNode = _schemaNode;
+			if (_validator) {
+				_schemaNode = schemaProperty(parentNode, key.getAs<std::string>());
+			}
+
+			GET_NEXT_NON_SPACE(c);
+			if (c != ':') {
+				_schemaNode = parentNode;
+				return unexpected(c);
+			}
+
+
+			GET_NEXT_NON_SPACE(c); 
+			int res = 0;
+			if (c == '{') {
+				res = readMap<Policy>(o, depth + 1);	
+			} else if (c == '[') {
+				res = readArray<Policy>(o, depth + 1);
+			} else if (isString(c, o) || isWord<Policy>(c, o) || isNumber<Policy>(c, o)) {
+				res = 1;
+			} else {
+				unexpected(c);
+			}
+			if (res == 1 && !schemaCheck(o)) res = 0;
+			_schemaNode = parentNode;
+			if (res != 1) {
+				addErrorPath(escapeKey(key.getAs<std::string>()));
+			}
+
+			if constexpr (Policy::duplicateKeys == DuplicateKeys::KEEP_LAST) {
+				map->insert_or_assign(std::move(*key.getAs<JString>()), JValue(std::move(o)));
+			} else {
+				map->try_emplace(std::move(*key.getAs<JString>()), std::move(o));
+			}
+			return res;
+		}
+
+		template<typename Policy>
+		std::pair<Value, int> parse() {
+			std::pair<Value, int> p;
+			char c = getFirstNonSpaceChar<Policy>();
+			int code = 0;
+			switch (c)
+			{
+			case '{':
+				code = readMap<Policy>(p.first, 1);
+				break;
+			case '[':
+				code = readArray<Policy>(p.first, 1);
+				break;
+			default:
+				if (isString(c, p.first) || isWord<Policy>(c, p.first) || isNumber<Policy>(c, p.first)) {
+					code = 1;
+				} else {
+					unexpected(c);
+				}
+				break;
+			}
+			if (code == 1 && !schemaCheck(p.first)) code = 0;
+			if (code != 1) finishError();
+			p.second = code;
+			return p;
+		}
+
+		template<typename Policy>
+		std::optional<Value> parseText(std::string_view text) {
+			if (text.size() > 0) {
+				reset(text.data(), text.data() + text.size());
+				auto[val, code] = parse<Policy>();
+				if (code == 1) return std::optional{ std::move(val) };
+				return std::nullopt;
+			}
+			ParseError error;
+			error.code = ErrorCode::EMPTY_INPUT;
+			setLastError(text, std::move(error));
+			return std::nullopt;
+		}
+	}
+
+	template<typename Policy>
+	std::optional<Value> parseFromFile(std::string_view path) {
+
+		_parser::init(path);
+
+		if (_parser::_eof) { //empty file case
+			ParseError error;
+			error.code = ErrorCode::FILE_ERROR;
+			_parser::setLastError(std::string_view(), std::move(error));
+			return std::nullopt;
+		}
+
+		auto [val, code] = _parser::parse<_parser::Padded<Policy>>();
+
+		_parser::freeBuffer();
+		if (code == 1) return std::optional{std::move(val)};
+		return std::nullopt;
+	}
+
+	template<typename Policy>
+	std::optional<Value> parseFromString(std::string_view jsonString) {
+		if constexpr (Policy::padding > 0) {
+			assert(jsonString.empty() || jsonString.data()[jsonString.size()] == '\0'); //padded policy needs '\0' right after input
+		}
+		return _parser::parseText<Policy>(jsonString);
+	}
+
+	template<typename Policy>
+	std::optional<Value> parseFromString(const std::string& jsonString) {
+		return _parser::parseText<_parser::Padded<Policy>>(jsonString);
+	}
+
+	template<typename Policy>
+	std::optional<Value> parseFromString(const char* jsonString) {
+		return _parser::parseText<_parser::Padded<Policy>>(jsonString);
+	}
+
+	extern template std::optional<Value> parseFromFile<DefaultPolicy>(std::string_view path);
+	extern template std::optional<Value> parseFromString<DefaultPolicy>(std::string_view jsonString);
+	extern template std::optional<Value> parseFromString<DefaultPolicy>(const std::string& jsonString);
+	extern template std::optional<Value> parseFromString<DefaultPolicy>(const char* jsonString);
+	extern template std::optional<Value> parseFromFile<StrictPolicy>(std::string_view path);
+	extern template std::optional<Value> parseFromString<StrictPolicy>(std::string_view jsonString);
+	extern template std::optional<Value> parseFromString<StrictPolicy>(const std::string& jsonString);
+	extern template std::optional<Value> parseFromString<StrictPolicy>(const char* jsonString);
+	extern template std::optional<Value> parseFromFile<LenientPolicy>(std::string_view path);
+	extern template std::optional<Value> parseFromString<LenientPolicy>(std::string_view jsonString);
+	extern template std::optional<Value> parseFromString<LenientPolicy>(const std::string& jsonString);
+	extern template std::optional<Value> parseFromString<LenientPolicy>(const char* jsonString);
+	extern template std::optional<Value> parseFromFile<PackedPolicy>(std::string_view path);
+	extern template std::optional<Value> parseFromString<PackedPolicy>(std::string_view jsonString);
+	extern template std::optional<Value> parseFromString<PackedPolicy>(const std::string& jsonString);
+	extern template std::optional<Value> parseFromString<PackedPolicy>(const char* jsonString);
+	extern template std::optional<Value> parseFromFile<PaddedPolicy>(std::string_view path);
+	extern template std::optional<Value> parseFromString<PaddedPolicy>(std::string_view jsonString);
+	extern template std::optional<Value> parseFromString<PaddedPolicy>(const std::string& jsonString);
+	extern template std::optional<Value> parseFromString<PaddedPolicy>(const char* jsonString);
+}
+
+#undef GET_NEXT
+#undef GET_NEXT_NON_SPACE
@@ -0,0 +1,549 @@
+//
+//  infyJSON lib
+//
+
+#include "Patch.h"
+#include <algorithm>
+#include <functional>
+#include <optional>
+
+namespace JSON {
+
+	namespace {
+
+		enum Seed : size_t {
+			NULL_SEED = 0x6a09e667,
+			BOOL_SEED = 0xbb67ae85,
+			INT_SEED = 0x3c6ef372,
+			DOUBLE_SEED = 0xa54ff53a,
+			STRING_SEED = 0x510e527f,
+			ARRAY_SEED = 0x9b05688c,
+			OBJECT_SEED = 0x1f83d9ab
+		};
+
+		size_t mix(size_t h) {
+			uint64_t x = static_cast<uint64_t>(h);
+			x ^= x >> 33;
+			x *= 0xff51afd7ed558ccdULL;
+			x ^= x >> 33;
+			x *= 0xc4ceb9fe1a85ec53ULL;
+			x ^= x >> 33;
+			return static_cast<size_t>(x);
+		}
+
+		size_t combine(size_t seed, size_t h) {
+			return mix(seed ^ (h + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2)));
+		}
+
+		template<typename ChildHash>
+		size_t hashWith(const Value& value, ChildHash&& child) {
+			if (value.is<JEmpty>()) return NULL_SEED;
+			if (value.is<JBool>()) return combine(BOOL_SEED, value.getAs<bool>());
+			if (value.is<int64_t>()) return combine(INT_SEED, std::hash<int64_t>{}(value.getAs<int64_t>()));
+			if (value.is<double>()) return combine(DOUBLE_SEED, std::hash<double>{}(value.getAs<double>()));
+			if (value.is<JString>()) return combine(STRING_SEED, std::hash<std::string>{}(value.getAs<std::string>()));
+			if (value.is<JArray>()) {
+				size_t result = ARRAY_SEED;
+				for (const auto& item : value.getAs<JArray>().value()) {
+					result = combine(result, child(item.value()));
+				}
+				return result;
+			}
+			//packed arrays hash like general arrays of the same numbers, since they are equal to them
+			if (value.is<JIntArray>()) {
+				size_t result = ARRAY_SEED;
+				for (int64_t number : value.getNumbers<int64_t>()) {
+					result = combine(result, combine(INT_SEED, std::hash<int64_t>{}(number)));
+				}
+				return result;
+			}
+			if (value.is<JDoubleArray>()) {
+				size_t result = ARRAY_SEED;
+				for (double number : value.getNumbers<double>()) {
+					result = combine(result, combine(DOUBLE_SEED, std::hash<double>{}(number)));
+				}
+				return result;
+			}
+			//objects are unordered, so entries are mixed separately and summed up
+			size_t result = 0;
+			for (const auto& [key, item] : value.getAs<JObject>().value()) {
+				result += combine(std::hash<std::string>{}(key), child(item.value()));
+			}
+			return combine(OBJECT_SEED, result);
+		}
+
+		std::string escapeToken(const std::string& token) {
+			std::string result;
+			result.reserve(token.size());
+			for (char c : token) {
+				if (c == '~') {
+					result += "~0";
+				} else if (c == '/') {
+					result += "~1";
+				} else {
+					result += c;
+				}
+			}
+			return result;
+		}
+
+		std::optional<std::vector<std::string>> parsePointer(const std::string& pointer) {
+			std::vector<std::string> tokens;
+			if (pointer.empty()) return tokens;
+			if (pointer[0] != '/') return std::nullopt;
+			size_t pos = 0;
+			while (pos != std::string::npos) {
+				size_t next = pointer.find('/', pos + 1);
+				std::string token;
+				for (size_t i = pos + 1; i < (next == std::string::npos ? pointer.size() : next); ++i) {
+					if (pointer[i] == '~') {
+						if (i + 1 >= pointer.size() || (pointer[i + 1] != '0' && pointer[i + 1] != '1')) return std::nullopt;
+						token += pointer[i + 1] == '0' ? '~' : '/';
+						++i;
+					} else {
+						token += pointer[i];
+					}
+				}
+				tokens.push_back(std::move(token));
+				pos = next;
+			}
+			return tokens;
+		}
+
+		std::optional<size_t> arrayIndex(const std::string& token, size_t size) {
+			if (token.empty() || token.size() > 18 || token.find_first_not_of("0123456789") != std::string::npos || (token.size() > 1 && token[0] == '0')) {
+				return std::nullopt;
+			}
+			size_t index = std::stoull(token);
+			if (index >= size) return std::nullopt;
+			return index;
+		}
+
+		Value* find(Value& root, const std::vector<std::string>& tokens, size_t count) {
+			Value* current = &root;
+			for (size_t i = 0; i < count; ++i) {
+				if (current->is<JObject>()) {
+					auto& map = current->getAs<JObject>();
+					auto it = map->find(tokens[i]);
+					if (it == map->end()) return nullptr;
+					current = &it->second.value();
+				} else if (current->is<JArray>() || current->isPacked()) {
+					auto& arr = current->getAs<JArray>();
+					auto index = arrayIndex(tokens[i], arr->size());
+					if (!index) return nullptr;
+					current = &arr[*index].value();
+				} else {
+					return nullptr;
+				}
+			}
+			return current;
+		}
+
+		Value* find(Value& root, const std::vector<std::string>& tokens) {
+			return find(root, tokens, tokens.size());
+		}
+
+		//read-only lookup for "test" and "copy": element of packed array is put into scratch, nothing is unpacked
+		const Value* lookup(const Value& root, const std::vector<std::string>& tokens, Value& scratch) {
+			const Value* current = &root;
+			for (const auto& token : tokens) {
+				if (current->is<JObject>()) {
+					const auto& map = current->getAs<JObject>().value();
+					auto it = map.find(token);
+					if (it == map.end()) return nullptr;
+					current = &it->second.value();
+				} else if (current->is<JArray>()) {
+					const auto& arr = current->getAs<JArray>().value();
+					auto index = arrayIndex(token, arr.size());
+					if (!index) return nullptr;
+					current = &arr[*index].value();
+				} else if (current->is<JIntArray>()) {
+					auto index = arrayIndex(token, current->getNumbers<int64_t>().size());
+					if (!index) return nullptr;
+					scratch.emplace<JNumber>(current->numberAt<int64_t>(*index));
+					current = &scratch;
+				} else if (current->is<JDoubleArray>()) {
+					auto index = arrayIndex(token, current->getNumbers<double>().size());
+					if (!index) return nullptr;
+					scratch.emplace<JNumber>(current->numberAt<double>(*index));
+					current = &scratch;
+				} else {
+					return nullptr;
+				}
+			}
+			return current;
+		}
+
+		size_t arraySize(const Value& value) {
+			return value.is<JIntArray>() ? value.getNumbers<int64_t>().size()
+				: value.is<JDoubleArray>() ? value.getNumbers<double>().size() : value.getAs<JArray>()->size();
+		}
+
+		//element of packed or general array, packed numbers are copied into scratch
+		const Value& element(const Value& arr, size_t index, Value& scratch) {
+			if (arr.is<JIntArray>()) {
+				scratch.emplace<JNumber>(arr.numberAt<int64_t>(index));
+				return scratch;
+			}
+			if (arr.is<JDoubleArray>()) {
+				scratch.emplace<JNumber>(arr.numberAt<double>(index));
+				return scratch;
+			}
+			return arr.getAs<JArray>()->at(index).value();
+		}
+
+		//equality of "test" operation (RFC 6902 4.6): numbers are equal if their values are, at any depth
+		bool testEqual(const Value& left, const Value& right) {
+			if (left.is<JNumber>() && right.is<JNumber>()) {
+				if (left.is<int64_t>() && right.is<int64_t>()) return left.getAs<int64_t>() == right.getAs<int64_t>();
+				return left.getAs<JNumber>() == right.getAs<JNumber>();
+			}
+			if ((left.is<JArray>() || left.isPacked()) && (right.is<JArray>() || right.isPacked())) {
+				size_t size = arraySize(left);
+				if (size != arraySize(right)) return false;
+				Value leftScratch, rightScratch;
+				for (size_t i = 0; i < size; ++i) {
+					if (!testEqual(element(left, i, leftScratch), element(right, i, rightScratch))) return false;
+				}
+				return true;
+			}
+			if (left.is<JObject>() && right.is<JObject>()) {
+				const auto& leftMap = left.getAs<JObject>().value();
+				const auto& rightMap = right.getAs<JObject>().value();
+				if (leftMap.size() != rightMap.size()) return false;
+				for (const auto& [key, item] : leftMap) {
+					auto it = rightMap.find(key);
+					if (it == rightMap.end() || !testEqual(item.value(), it->second.value())) return false;
+				}
+				return true;
+			}
+			return left == right;
+		}
+
+		//how to revert one change made by applyPatch, so target doesn't have to be copied up front
+		struct Undo {
+			enum Kind {
+				ASSIGN, //put value back at path
+				INSERT, //add value at path, like "add" operation
+				ERASE //remove path
+			};
+			Kind kind;
+			std::vector<std::string> path;
+			Value value;
+		};
+
+		bool add(Value& root, const std::vector<std::string>& tokens, Value value, std::vector<Undo>* undo) {
+			if (tokens.empty()) {
+				if (undo) undo->push_back({ Undo::ASSIGN, tokens, std::move(root) });
+				root = std::move(value);
+				return true;
+			}
+			Value* parent = find(root, tokens, tokens.size() - 1);
+			if (!parent) return false;
+			const auto& last = tokens.back();
+			if (parent->is<JObject>()) {
+				auto& map = parent->getAs<JObject>();
+				auto [it, inserted] = map->try_emplace(last);
+				if (undo) {
+					undo->push_back(inserted ? Undo{ Undo::ERASE, tokens, Value() } : Undo{ Undo::ASSIGN, tokens, std::move(it->second.value()) });
+				}
+				it->second.value() = std::move(value);
+				return true;
+			}
+			if (parent->is<JArray>() || parent->isPacked()) {
+				auto& arr = parent->getAs<JArray>();
+				auto index = last == "-" ? std::optional{ arr->size() } : arrayIndex(last, arr->size() + 1);
+				if (!index) return false;
+				arr->emplace(arr->begin() + static_cast<std::ptrdiff_t>(*index), std::move(value));
+				if (undo) {
+					undo->push_back({ Undo::ERASE, tokens, Value() });
+					undo->back().path.back() = std::to_string(*index);
+				}
+				return true;
+			}
+			return false;
+		}
+
+		std::optional<Value> remove(Value& root, const std::vector<std::string>& tokens) {
+			if (tokens.empty()) return std::nullopt;
+			Value* parent = find(root, tokens, tokens.size() - 1);
+			if (!parent) return std::nullopt;
+			const auto& last = tokens.back();
+			if (parent->is<JObject>()) {
+				auto& map = parent->getAs<JObject>();
+				auto it = map->find(last);
+				if (it == map->end()) return std::nullopt;
+				std::optional<Value> removed{ std::move(it->second.value()) };
+				map->erase(it);
+				return removed;
+			}
+			if (parent->is<JArray>() || parent->isPacked()) {
+				auto& arr = parent->getAs<JArray>();
+				auto index = arrayIndex(last, arr->size());
+				if (!index) return std::nullopt;
+				auto it = arr->begin() + static_cast<std::ptrdiff_t>(*index);
+				std::optional<Value> removed{ std::move(it->value()) };
+				arr->erase(it);
+				return removed;
+			}
+			return std::nullopt;
+		}
+
+		Value operation(const char* op, const std::string& path) {
+			Value result;
+			result["op"].value() = Value(std::string(op));
+			result["path"].value() = Value(path);
+			return result;
+		}
+
+		class Differ {
+			HashCache _cache;
+			JArray& _patch;
+
+			void replace(const std::string& path, const Value& to) {
+				auto op = operation("replace", path);
+				op["value"].value() = Value(to);
+				_patch->emplace_back(std::move(op));
+			}
+
+			//same steps as for general arrays, but numbers are compared directly
+			template<typename T>
+			void runNumbers(NumberSpan<T> from, NumberSpan<T> to, const std::string& path) {
+				size_t head = 0;
+				while (head < from.size() && head < to.size() && from[head] == to[head]) {
+					++head;
+				}
+				size_t tail = 0;
+				while (tail < from.size() - head && tail < to.size() - head && from[from.size() - 1 - tail] == to[to.size() - 1 - tail]) {
+					++tail;
+				}
+				size_t fromEnd = from.size() - tail;
+				size_t toEnd = to.size() - tail;
+				size_t common = std::min(fromEnd, toEnd);
+				for (size_t i = head; i < common; ++i) {
+					if (from[i] != to[i]) {
+						replace(path + '/' + std::to_string(i), Value(to[i]));
+					}
+				}
+				for (size_t i = fromEnd; i > common; --i) {
+					_patch->emplace_back(operation("remove", path + '/' + std::to_string(common)));
+				}
+				for (size_t i = common; i < toEnd; ++i) {
+					auto op = operation("add", path + '/' + std::to_string(i));
+					op["value"].value() = Value(to[i]);
+					_patch->emplace_back(std::move(op));
+				}
+			}
+
+		public:
+			explicit Differ(JArray& patch) : _patch{ patch } {}
+
+			void run(const Value& from, const Value& to, const std::string& path) {
+				if (_cache.equal(from, to)) return;
+
+				if (from.is<JObject>() && to.is<JObject>()) {
+					const auto& fromMap = from.getAs<JObject>().value();
+					const auto& toMap = to.getAs<JObject>().value();
+					for (const auto& [key, item] : fromMap) {
+						auto childPath = path + '/' + escapeToken(key);
+						if (auto it = toMap.find(key); it == toMap.end()) {
+							_patch->emplace_back(operation("remove", childPath));
+						} else {
+							run(item.value(), it->second.value(), childPath);
+						}
+					}
+					for (const auto& [key, item] : toMap) {
+						if (fromMap.count(key) == 0) {
+							auto op = operation("add", path + '/' + escapeToken(key));
+							op["value"].value() = Value(item.value());
+							_patch->emplace_back(std::move(op));
+						}
+					}
+				} else if (from.is<JArray>() && to.is<JArray>()) {
+					const auto& fromArr = from.getAs<JArray>().value();
+					const auto& toArr = to.getAs<JArray>().value();
+					//unchanged head and tail are skipped by hash, the middle is updated in place
+					size_t head = 0;
+					while (head < fromArr.size() && head < toArr.size() && _cache.equal(fromArr[head].value(), toArr[head].value())) {
+						++head;
+					}
+					size_t tail = 0;
+					while (tail < fromArr.size() - head && tail < toArr.size() - head
+						&& _cache.equal(fromArr[fromArr.size() - 1 - tail].value(), toArr[toArr.size() - 1 - tail].value())) {
+						++tail;
+					}
+					size_t fromEnd = fromArr.size() - tail;
+					size_t toEnd = toArr.size() - tail;
+					size_t common = std::min(fromEnd, toEnd);
+					for (size_t i = head; i < common; ++i) {
+						run(fromArr[i].value(), toArr[i].value(), path + '/' + std::to_string(i));
+					}
+					for (size_t i = fromEnd; i > common; --i) {
+						_patch->emplace_back(operation("remove", path + '/' + std::to_string(common)));
+					}
+					for (size_t i = common; i < toEnd; ++i) {
+						auto op = operation("add", path + '/' + std::to_string(i));
+						op["value"].value() = Value(toArr[i].value());
+						_patch->emplace_back(std::move(op));
+					}
+				} else if (from.is<JIntArray>() && to.is<JIntArray>()) {
+					runNumbers(from.getNumbers<int64_t>(), to.getNumbers<int64_t>(), path);
+				} else if (from.is<JDoubleArray>() && to.is<JDoubleArray>()) {
+					runNumbers(from.getNumbers<double>(), to.getNumbers<double>(), path);
+				} else {
+					replace(path, to);
+				}
+			}
+		};
+
+		void revert(Value& root, std::vector<Undo>& undo) {
+			for (auto it = undo.rbegin(); it != undo.rend(); ++it) {
+				switch (it->kind) {
+				case Undo::ASSIGN:
+					*find(root, it->path) = std::move(it->value);
+					break;
+				case Undo::INSERT:
+					add(root, it->path, std::move(it->value), nullptr);
+					break;
+				case Undo::ERASE:
+					remove(root, it->path);
+					break;
+				}
+			}
+		}
+
+		Value mergeDiff(const Value& from, const Value& to, HashCache& cache) {
+			if (!from.is<JObject>() || !to.is<JObject>()) return to;
+			Value result;
+			auto& patch = result.emplace<JObject>();
+			const auto& fromMap = from.getAs<JObject>().value();
+			const auto& toMap = to.getAs<JObject>().value();
+			for (const auto& [key, item] : fromMap) {
+				if (toMap.count(key) == 0) {
+					patch->try_emplace(key); //null removes key
+				}
+			}
+			for (const auto& [key, item] : toMap) {
+				auto it = fromMap.find(key);
+				if (it == fromMap.end()) {
+					patch->try_emplace(key, item.value());
+				} else if (!cache.equal(it->second.value(), item.value())) {
+					patch->try_emplace(key, mergeDiff(it->second.value(), item.value(), cache));
+				}
+			}
+			return result;
+		}
+
+		bool applyOperation(Value& root, const Value& op, std::vector<Undo>& undo) {
+			if (!op.is<JObject>() || !op["op"]->is<JString>() || !op["path"]->is<JString>()) return false;
+			const auto& name = op["op"]->getAs<std::string>();
+			auto path = parsePointer(op["path"]->getAs<std::string>());
+			if (!path) return false;
+
+			if (name == "add" || name == "replace" || name == "test") {
+				if (!op.hasKey("value")) return false;
+				const Value& value = op["value"].value();
+				if (name == "add") return add(root, *path, value, &undo);
+				if (name == "test") {
+					Value scratch;
+					const Value* target = lookup(root, *path, scratch);
+					return target && testEqual(*target, value);
+				}
+				Value* target = find(root, *path);
+				if (!target) return false;
+				undo.push_back({ Undo::ASSIGN, *path, std::move(*target) });
+				*target = Value(value);
+				return true;
+			}
+			if (name == "remove") {
+				auto removed = remove(root, *path);
+				if (!removed) return false;
+				undo.push_back({ Undo::INSERT, *path, std::move(*removed) });
+				return true;
+			}
+			if (name == "move" || name == "copy") {
+				if (!op["from"]->is<JString>()) return false;
+				auto from = parsePointer(op["from"]->getAs<std::string>());
+				if (!from) return false;
+				if (name == "copy") {
+					Value scratch;
+					const Value* source = lookup(root, *from, scratch);
+					return source && add(root, *path, Value(*source), &undo);
+				}
+				if (*from == *path) return find(root, *from) != nullptr;
+				if (from->size() < path->size() && std::equal(from->begin(), from->end(), path->begin())) {
+					return false; //can't move value into its own child
+				}
+				auto moved = remove(root, *from);
+				if (!moved) return false;
+				undo.push_back({ Undo::INSERT, *from, *moved }); //copy of moved subtree only
+				return add(root, *path, std::move(*moved), &undo);
+			}
+			return false;
+		}
+	}
+
+	size_t hash(const Value& value) {
+		return hashWith(value, [](const Value& child) { return hash(child); });
+	}
+
+	size_t HashCache::hash(const Value& value) {
+		if (auto it = _hashes.find(&value); it != _hashes.end()) {
+			return it->second;
+		}
+		size_t result = hashWith(value, [this](const Value& child) { return hash(child); });
+		_hashes.emplace(&value, result);
+		return result;
+	}
+
+	bool HashCache::equal(const Value& left, const Value& right) {
+		if (&left == &right) return true;
+		return hash(left) == hash(right) && left == right;
+	}
+
+	void HashCache::clear() {
+		_hashes.clear();
+	}
+
+	Value diff(const Value& from, const Value& to) {
+		Value result;
+		auto& patch = result.emplace<JArray>();
+		Differ(patch).run(from, to, "");
+		return result;
+	}
+
+	bool applyPatch(Value& target, const Value& patch) {
+		if (!patch.is<JArray>()) return false;
+		std::vector<Undo> undo;
+		for (const auto& op : patch.getAs<JArray>().value()) {
+			if (!applyOperation(target, op.value(), undo)) {
+				revert(target, undo);
+				return false;
+			}
+		}
+		return true;
+	}
+
+	Value mergeDiff(const Value& from, const Value& to) {
+		HashCache cache;
+		return mergeDiff(from, to, cache);
+	}
+
+	void mergePatch(Value& target, const Value& patch) {
+		if (!patch.is<JObject>()) {
+			target = Value(patch);
+			return;
+		}
+		if (!target.is<JObject>()) {
+			target.emplace<JObject>();
+		}
+		auto& map = target.getAs<JObject>();
+		for (const auto& [key, item] : patch.getAs<JObject>().value()) {
+			if (item->is<JEmpty>()) {
+				map->erase(key);
+			} else {
+				mergePatch(map->try_emplace(key).first->second.value(), item.value());
+			}
+		}
+	}
+}
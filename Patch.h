@@ -0,0 +1,34 @@
+//
+//  infyJSON lib
+//
+#pragma once
+
+#include "Value.h"
+
+namespace JSON {
+
+	//Structural hash: equal values always have equal hashes, key order of objects doesn't matter
+	size_t hash(const Value& value);
+
+	//Optional memo of subtree hashes, so repeated comparisons don't walk unchanged subtrees again.
+	//Hashes are keyed by address: documents it has seen must not change while it is in use,
+	//call clear() before using it again after modifying them.
+	class HashCache {
+		std::unordered_map<const Value*, size_t> _hashes;
+	public:
+		size_t hash(const Value& value);
+		//different hashes exit immediately, equal hashes are confirmed with operator==
+		bool equal(const Value& left, const Value& right);
+		void clear();
+	};
+
+	//RFC 6902 JSON Patch: returns array of operations which turn `from` into `to`.
+	//Uses its own HashCache for the call, equal hashes are confirmed with operator==
+	Value diff(const Value& from, const Value& to);
+	//applies all operations or none of them, returns false if patch is malformed or some operation fails
+	bool applyPatch(Value& target, const Value& patch);
+
+	//RFC 7386 JSON Merge Patch
+	Value mergeDiff(const Value& from, const Value& to);
+	void mergePatch(Value& target, const Value& patch);
+}
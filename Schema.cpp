@@ -0,0 +1,396 @@
+//
+//  infyJSON lib
+//
+
+#include "Schema.h"
+#include <cmath>
+#include <limits>
+
+namespace JSON {
+
+	namespace {
+
+		using _schema::Node;
+		using _schema::none;
+
+		unsigned typeFromName(const std::string& name) {
+			if (name == "null") return _schema::NULL_TYPE;
+			if (name == "boolean") return _schema::BOOLEAN;
+			if (name == "object") return _schema::OBJECT;
+			if (name == "array") return _schema::ARRAY;
+			if (name == "number") return _schema::NUMBER | _schema::INTEGER;
+			if (name == "integer") return _schema::INTEGER;
+			if (name == "string") return _schema::STRING;
+			return 0;
+		}
+
+		unsigned typeOf(const Value& value) {
+			if (value.is<JEmpty>()) return _schema::NULL_TYPE;
+			if (value.is<JBool>()) return _schema::BOOLEAN;
+			if (value.is<JObject>()) return _schema::OBJECT;
+			if (value.is<JArray>() || value.isPacked()) return _schema::ARRAY;
+			if (value.is<JString>()) return _schema::STRING;
+			double number = value.getAs<JNumber>();
+			return std::floor(number) == number ? _schema::NUMBER | _schema::INTEGER : _schema::NUMBER;
+		}
+
+		//libstdc++'s default regex executor recurses once per input character and overflows the stack on long strings,
+		//polynomial mode runs Thompson NFA with bounded stack instead (back-references are rejected in this mode)
+#ifdef __GLIBCXX__
+		constexpr auto patternSyntax = std::regex::ECMAScript | std::regex::optimize | std::regex_constants::__polynomial;
+#else
+		constexpr auto patternSyntax = std::regex::ECMAScript | std::regex::optimize;
+#endif
+
+		bool equal(const Value& left, const Value& right) {
+			if (left.is<JNumber>() && right.is<JNumber>()) {
+				return left.getAs<JNumber>() == right.getAs<JNumber>();
+			}
+			return left == right;
+		}
+
+		class Compiler {
+			const Value& _root;
+			std::vector<Node>& _nodes;
+			std::unordered_map<const Value*, size_t> _compiled;
+			bool _ok{ true };
+
+			//resolves local JSON pointer like "#/definitions/item"
+			const Value* resolvePointer(const std::string& ref) {
+				if (ref.empty() || ref[0] != '#') return nullptr;
+				const Value* current = &_root;
+				size_t pos = 1;
+				while (pos < ref.size()) {
+					if (ref[pos] != '/') return nullptr;
+					size_t next = ref.find('/', pos + 1);
+					std::string token = ref.substr(pos + 1, next == std::string::npos ? std::string::npos : next - pos - 1);
+					std::string unescaped;
+					for (size_t i = 0; i < token.size(); ++i) {
+						if (token[i] == '~' && i + 1 < token.size()) {
+							unescaped += token[i + 1] == '1' ? '/' : '~';
+							++i;
+						} else {
+							unescaped += token[i];
+						}
+					}
+					if (current->is<JObject>() && current->hasKey(unescaped)) {
+						current = &(*current)[unescaped].value();
+					} else if (current->is<JArray>() && !unescaped.empty() && unescaped.find_first_not_of("0123456789") == std::string::npos
+						&& std::stoul(unescaped) < current->getAs<JArray>()->size()) {
+						current = &(*current)[static_cast<size_t>(std::stoul(unescaped))].value();
+					} else if (current->isPacked()) {
+						return nullptr; //elements of packed array are numbers, which are never schemas
+					} else {
+						return nullptr;
+					}
+					pos = next == std::string::npos ? ref.size() : next;
+				}
+				return current;
+			}
+
+			template<typename T>
+			std::optional<T> number(const Value& schema, const std::string& key) {
+				if (!schema.hasKey(key)) return std::nullopt;
+				const auto& v = schema[key];
+				if (!v->is<JNumber>()) {
+					_ok = false;
+					return std::nullopt;
+				}
+				if constexpr (std::is_integral_v<T>) {
+					//counts like minLength must be non-negative integers, anything else is a broken schema
+					double d = v->getAs<double>();
+					if (!(d >= 0 && d < std::ldexp(1.0, std::numeric_limits<T>::digits)) || std::trunc(d) != d) {
+						_ok = false;
+						return std::nullopt;
+					}
+					return static_cast<T>(d);
+				} else {
+					return v->getAs<T>();
+				}
+			}
+
+			void exclusive(const Value& schema, const std::string& key, std::optional<double>& target, std::optional<double>& inclusive) {
+				if (!schema.hasKey(key)) return;
+				const auto& v = schema[key];
+				if (v->is<JBool>()) { //draft-04 form modifies minimum/maximum
+					if (v->getAs<bool>()) {
+						target = inclusive;
+						inclusive.reset();
+					}
+				} else {
+					target = number<double>(schema, key);
+				}
+			}
+
+		public:
+			Compiler(const Value& root, std::vector<Node>& nodes) : _root{ root }, _nodes{ nodes } {}
+
+			bool ok() const {
+				return _ok;
+			}
+
+			size_t compile(const Value& schema) {
+				if (auto it = _compiled.find(&schema); it != _compiled.end()) {
+					return it->second;
+				}
+				size_t index = _nodes.size();
+				_nodes.emplace_back();
+				_compiled.emplace(&schema, index);
+
+				Node node;
+				if (schema.is<JBool>()) {
+					node.never = !schema.getAs<bool>();
+					_nodes[index] = std::move(node);
+					return index;
+				}
+				if (!schema.is<JObject>()) {
+					_ok = false;
+					return index;
+				}
+
+				if (schema.hasKey("$ref")) {
+					const auto& ref = schema["$ref"];
+					const Value* target = ref->is<JString>() ? resolvePointer(ref->getAs<std::string>()) : nullptr;
+					if (!target) {
+						_ok = false;
+						return index;
+					}
+					node.ref = compile(*target);
+					_nodes[index] = std::move(node);
+					return index;
+				}
+
+				if (schema.hasKey("type")) {
+					const auto& type = schema["type"];
+					node.types = 0;
+					if (type->is<JString>()) {
+						node.types = typeFromName(type->getAs<std::string>());
+					} else if (type->is<JArray>()) {
+						for (const auto& name : type->getAs<JArray>().value()) {
+							if (name->is<JString>()) node.types |= typeFromName(name->getAs<std::string>());
+						}
+					}
+					if (node.types == 0) _ok = false;
+				}
+
+				if (schema.hasKey("enum")) {
+					const auto& values = schema["enum"];
+					if (values->is<JArray>()) {
+						node.enumValues.emplace();
+						for (const auto& v : values->getAs<JArray>().value()) {
+							node.enumValues->push_back(v.value());
+						}
+					} else if (values->is<JIntArray>()) {
+						node.enumValues.emplace();
+						for (int64_t number : values->getNumbers<int64_t>()) {
+							node.enumValues->emplace_back(number);
+						}
+					} else if (values->is<JDoubleArray>()) {
+						node.enumValues.emplace();
+						for (double number : values->getNumbers<double>()) {
+							node.enumValues->emplace_back(number);
+						}
+					} else {
+						_ok = false;
+					}
+				}
+				if (schema.hasKey("const")) {
+					node.enumValues = std::vector<Value>{ schema["const"].value() };
+				}
+
+				node.minimum = number<double>(schema, "minimum");
+				node.maximum = number<double>(schema, "maximum");
+				node.multipleOf = number<double>(schema, "multipleOf");
+				exclusive(schema, "exclusiveMinimum", node.exclusiveMinimum, node.minimum);
+				exclusive(schema, "exclusiveMaximum", node.exclusiveMaximum, node.maximum);
+
+				node.minLength = number<size_t>(schema, "minLength");
+				node.maxLength = number<size_t>(schema, "maxLength");
+				node.minItems = number<size_t>(schema, "minItems");
+				node.maxItems = number<size_t>(schema, "maxItems");
+				node.minProperties = number<size_t>(schema, "minProperties");
+				node.maxProperties = number<size_t>(schema, "maxProperties");
+
+				if (schema.hasKey("pattern")) {
+					const auto& pattern = schema["pattern"];
+					if (!pattern->is<JString>()) {
+						_ok = false;
+					} else {
+						try {
+							const auto& source = pattern->getAs<std::string>();
+							std::regex(source, patternSyntax); //checks pattern on its own, wrapping could balance stray parentheses
+							//JSON Schema patterns aren't anchored: one regex_match with wrapped pattern is linear,
+							//regex_search restarts from every position and is quadratic
+							node.pattern.emplace("[\\s\\S]*(?:" + source + ")[\\s\\S]*", patternSyntax);
+						} catch (const std::regex_error&) {
+							_ok = false;
+						}
+					}
+				}
+
+				if (schema.hasKey("required")) {
+					const auto& required = schema["required"];
+					if (required->is<JArray>()) {
+						for (const auto& key : required->getAs<JArray>().value()) {
+							if (key->is<JString>()) node.required.push_back(key->getAs<std::string>());
+						}
+					}
+				}
+
+				if (schema.hasKey("properties")) {
+					const auto& properties = schema["properties"];
+					if (properties->is<JObject>()) {
+						for (const auto& [key, child] : properties->getAs<JObject>().value()) {
+							node.properties.emplace(key, compile(child.value()));
+						}
+					} else {
+						_ok = false;
+					}
+				}
+				if (schema.hasKey("additionalProperties")) {
+					node.additionalProperties = compile(schema["additionalProperties"].value());
+				}
+
+				if (schema.hasKey("items")) {
+					const auto& items = schema["items"];
+					if (items->is<JArray>()) {
+						for (const auto& child : items->getAs<JArray>().value()) {
+							node.tupleItems.push_back(compile(child.value()));
+						}
+						if (schema.hasKey("additionalItems")) {
+							node.items = compile(schema["additionalItems"].value());
+						}
+					} else {
+						node.items = compile(items.value());
+					}
+				}
+
+				_nodes[index] = std::move(node);
+				return index;
+			}
+		};
+	}
+
+	std::optional<Schema> Schema::compile(const Value& schema) {
+		Schema result;
+		Compiler compiler(schema, result._nodes);
+		compiler.compile(schema);
+		if (!compiler.ok()) return std::nullopt;
+		return std::optional{ std::move(result) };
+	}
+
+	const _schema::Node* Schema::root() const {
+		return item(_nodes.empty() ? nullptr : &_nodes.front(), none);
+	}
+
+	const _schema::Node* Schema::property(const _schema::Node* node, const std::string& key) const {
+		if (!node) return nullptr;
+		if (node->never) return node;
+		if (auto it = node->properties.find(key); it != node->properties.end()) {
+			return item(&_nodes[it->second], none);
+		}
+		return node->additionalProperties == none ? nullptr : item(&_nodes[node->additionalProperties], none);
+	}
+
+	//index == none just resolves $ref chain of the node itself
+	const _schema::Node* Schema::item(const _schema::Node* node, size_t index) const {
+		for (size_t hops = 0; node && node->ref != none; ++hops) {
+			if (hops == _nodes.size()) return nullptr; //$ref cycle without any constraints
+			node = &_nodes[node->ref];
+		}
+		if (!node || index == none || node->never) return node;
+		if (index < node->tupleItems.size()) {
+			return item(&_nodes[node->tupleItems[index]], none);
+		}
+		return node->items == none ? nullptr : item(&_nodes[node->items], none);
+	}
+
+	bool Schema::accepts(const _schema::Node* node, _schema::Type type) const {
+		return !node || (!node->never && (node->types & type) != 0);
+	}
+
+	bool Schema::check(const _schema::Node* node, const Value& value) const {
+		if (!node) return true;
+		if (node->never) return false;
+
+		unsigned type = typeOf(value);
+		if ((node->types & type) == 0) return false;
+
+		if (node->enumValues) {
+			bool found = false;
+			for (const auto& v : *node->enumValues) {
+				if (equal(v, value)) {
+					found = true;
+					break;
+				}
+			}
+			if (!found) return false;
+		}
+
+		if (type & _schema::NUMBER) {
+			double number = value.getAs<JNumber>();
+			if (node->minimum && number < *node->minimum) return false;
+			if (node->maximum && number > *node->maximum) return false;
+			if (node->exclusiveMinimum && number <= *node->exclusiveMinimum) return false;
+			if (node->exclusiveMaximum && number >= *node->exclusiveMaximum) return false;
+			if (node->multipleOf && *node->multipleOf != 0) {
+				double quotient = number / *node->multipleOf;
+				if (std::fabs(quotient - std::round(quotient)) > 1e-9) return false;
+			}
+		} else if (type == _schema::STRING) {
+			const auto& str = value.getAs<std::string>();
+			if (node->minLength && str.size() < *node->minLength) return false;
+			if (node->maxLength && str.size() > *node->maxLength) return false;
+			if (node->pattern) {
+				try {
+					if (!std::regex_match(str, *node->pattern)) return false;
+				} catch (const std::regex_error&) {
+					return false; //other standard libraries report too complex match this way
+				}
+			}
+		} else if (type == _schema::ARRAY) {
+			size_t size = value.is<JIntArray>() ? value.getNumbers<int64_t>().size()
+				: value.is<JDoubleArray>() ? value.getNumbers<double>().size() : value.getAs<JArray>()->size();
+			if (node->minItems && size < *node->minItems) return false;
+			if (node->maxItems && size > *node->maxItems) return false;
+		} else if (type == _schema::OBJECT) {
+			const auto& map = value.getAs<JObject>();
+			if (node->minProperties && map->size() < *node->minProperties) return false;
+			if (node->maxProperties && map->size() > *node->maxProperties) return false;
+			for (const auto& key : node->required) {
+				if (map->count(key) == 0) return false;
+			}
+		}
+		return true;
+	}
+
+	bool Schema::validate(const Value& value, const _schema::Node* node) const {
+		if (!check(node, value)) return false;
+		if (!node) return true;
+		if (value.is<JObject>()) {
+			for (const auto& [key, child] : value.getAs<JObject>().value()) {
+				if (!validate(child.value(), property(node, key))) return false;
+			}
+		} else if (value.is<JArray>()) {
+			const auto& arr = value.getAs<JArray>().value();
+			for (size_t i = 0; i < arr.size(); ++i) {
+				if (!validate(arr[i].value(), item(node, i))) return false;
+			}
+		} else if (value.isPacked()) {
+			Value number;
+			for (size_t i = 0; i < value.getNumbers<int64_t>().size(); ++i) {
+				number.emplace<JNumber>(value.getNumbers<int64_t>()[i]);
+				if (!validate(number, item(node, i))) return false;
+			}
+			for (size_t i = 0; i < value.getNumbers<double>().size(); ++i) {
+				number.emplace<JNumber>(value.getNumbers<double>()[i]);
+				if (!validate(number, item(node, i))) return false;
+			}
+		}
+		return true;
+	}
+
+	bool Schema::validate(const Value& value) const {
+		return validate(value, root());
+	}
+}
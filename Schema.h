@@ -0,0 +1,72 @@
+//
+//  infyJSON lib
+//
+#pragma once
+
+#include "Value.h"
+#include <optional>
+#include <regex>
+#include <string_view>
+
+namespace JSON {
+
+	namespace _schema {
+
+		enum Type : unsigned {
+			NULL_TYPE = 1 << 0,
+			BOOLEAN = 1 << 1,
+			OBJECT = 1 << 2,
+			ARRAY = 1 << 3,
+			NUMBER = 1 << 4,
+			INTEGER = 1 << 5,
+			STRING = 1 << 6,
+			ANY = NULL_TYPE | BOOLEAN | OBJECT | ARRAY | NUMBER | INTEGER | STRING
+		};
+
+		constexpr size_t none = static_cast<size_t>(-1);
+
+		//one compiled schema object, children are referenced by index in Schema::_nodes
+		struct Node {
+			unsigned types{ ANY };
+			bool never{ false }; //false schema, rejects everything
+			size_t ref{ none };
+
+			std::optional<double> minimum, maximum, exclusiveMinimum, exclusiveMaximum, multipleOf;
+			std::optional<size_t> minLength, maxLength, minItems, maxItems, minProperties, maxProperties;
+			std::optional<std::regex> pattern;
+			std::optional<std::vector<Value>> enumValues;
+
+			std::vector<std::string> required;
+			std::unordered_map<std::string, size_t> properties;
+			size_t additionalProperties{ none };
+			size_t items{ none };
+			std::vector<size_t> tupleItems;
+		};
+	}
+
+	//JSON Schema compiled into flat list of nodes.
+	//Supports type, enum, const, minimum/maximum (with exclusive forms), multipleOf, minLength/maxLength,
+	//pattern, required, properties, additionalProperties, min/maxProperties, items, min/maxItems and local $ref.
+	class Schema {
+		std::vector<_schema::Node> _nodes;
+
+		bool validate(const Value& value, const _schema::Node* node) const;
+
+	public:
+		static std::optional<Schema> compile(const Value& schema);
+
+		bool validate(const Value& value) const;
+
+		//Parser hooks: node == nullptr means "no constraints"
+		const _schema::Node* root() const;
+		const _schema::Node* property(const _schema::Node* node, const std::string& key) const;
+		const _schema::Node* item(const _schema::Node* node, size_t index) const;
+		bool accepts(const _schema::Node* node, _schema::Type type) const;
+		//checks node's own constraints only, children are expected to be validated already
+		bool check(const _schema::Node* node, const Value& value) const;
+	};
+
+	//Parse and validate in one pass, stops at the first value which doesn't match the schema
+	std::optional<Value> parseFromFile(std::string_view path, const Schema& schema);
+	std::optional<Value> parseFromString(std::string_view jsonString, const Schema& schema);
+}
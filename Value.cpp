@@ -8,15 +8,50 @@ namespace JSON {
 
 	namespace {
 		const JValue dummy;
+
+		template<typename T>
+		bool equalNumbers(NumberSpan<T> numbers, const std::vector<JValue>& arr) {
+			if (numbers.size() != arr.size()) return false;
+			for (size_t i = 0; i < arr.size(); ++i) {
+				if (!arr[i]->is<T>() || arr[i]->getAs<T>() != numbers[i]) return false;
+			}
+			return true;
+		}
+
+		//packed array equals general array of the same numbers of the same type
+		bool equalPacked(const Value& packed, const Value& general) {
+			const auto& arr = general.getAs<JArray>().value();
+			return packed.is<JIntArray>() ? equalNumbers(packed.getNumbers<int64_t>(), arr) : equalNumbers(packed.getNumbers<double>(), arr);
+		}
+
+		template<typename T>
+		JArray toArray(const std::vector<T>& numbers) {
+			JArray arr;
+			arr->reserve(numbers.size());
+			for (T number : numbers) {
+				arr->emplace_back(number);
+			}
+			return arr;
+		}
 	}
 
 	bool Value::operator==(const Value& right) const {
 		if (this == &right) return true;
+		if (isPacked() && right.is<JArray>()) return equalPacked(*this, right);
+		if (right.isPacked() && is<JArray>()) return equalPacked(right, *this);
  		return _data == right._data;
 	}
 
 	bool Value::operator!=(const Value& right) const {
-		return _data != right._data;
+		return !(*this == right);
+	}
+
+	void Value::unpack() {
+		if (auto ints = std::get_if<JIntArray>(&_data)) {
+			_data = toArray(ints->value());
+		} else if (auto doubles = std::get_if<JDoubleArray>(&_data)) {
+			_data = toArray(doubles->value());
+		}
 	}
 
 	bool Value::hasKey(const std::string& right) const
@@ -25,7 +60,7 @@ namespace JSON {
 	}
 
 	JValue& Value::operator[](const size_t right) {
-		if (!is<JArray>()) {
+		if (!is<JArray>() && !isPacked()) {
 			_data = JArray{};
 		}
 		auto& array = getAs<JArray>();
@@ -56,6 +91,9 @@ namespace JSON {
 
 	const JValue& Value::operator[](const size_t right) const
 	{
+		if (isPacked()) {
+			throw std::bad_variant_access();
+		}
 		if (is<JArray>()) {
 			auto& arr = getAs<JArray>();
 			if (right < arr->size()) {
@@ -88,7 +126,11 @@ namespace JSON {
 					value->write(result);
 					result += ',';
 				}
-				result.back() = '}';
+				if (result.back() == ',') {
+					result.back() = '}';
+				} else {
+					result += '}';
+				}
 			}
 			else if constexpr (std::is_same_v<decayed_t, JArray>) {
 				result += '[';
@@ -96,7 +138,23 @@ namespace JSON {
 					value->write(result);
 					result += ',';
 				}
-				result.back() = ']';
+				if (result.back() == ',') {
+					result.back() = ']';
+				} else {
+					result += ']';
+				}
+			}
+			else if constexpr (std::is_same_v<decayed_t, JIntArray> || std::is_same_v<decayed_t, JDoubleArray>) {
+				result += '[';
+				for (auto number : arg.value()) {
+					result += std::to_string(number);
+					result += ',';
+				}
+				if (result.back() == ',') {
+					result.back() = ']';
+				} else {
+					result += ']';
+				}
 			}
 			else {
 				throw std::bad_variant_access();
@@ -49,6 +49,11 @@ namespace JSON {
 			decltype(std::declval<T>().end())>>
 			: std::true_type {};
 
+		template <typename T, typename = void>
+		struct is_map : std::false_type {};
+		template <typename T>
+		struct is_map<T, std::void_t<typename T::mapped_type>> : std::true_type {};
+
 		template<typename T, typename U> //https://stackoverflow.com/questions/31171682/type-trait-for-copying-cv-reference-qualifiers
 		struct copy_cv_reference
 		{
@@ -108,15 +113,28 @@ namespace JSON {
 				return *this;
 			}
 
-			typename std::add_lvalue_reference_t<T> operator*() const {
+			//const HeapObject gives const access only, so reads through const values never reach non-const overloads
+			T& operator*() {
+				return std::unique_ptr<T>::operator*();
+			}
+
+			const T& operator*() const {
+				return std::unique_ptr<T>::operator*();
+			}
+
+			T& value() {
 				return std::unique_ptr<T>::operator*();
 			}
 
-			typename std::add_lvalue_reference_t<T> value() const {
+			const T& value() const {
 				return std::unique_ptr<T>::operator*();
 			}
 
-			T* operator->() const noexcept {
+			T* operator->() noexcept {
+				return std::unique_ptr<T>::operator->();
+			}
+
+			const T* operator->() const noexcept {
 				return std::unique_ptr<T>::operator->();
 			}
 
@@ -125,9 +143,17 @@ namespace JSON {
 				return std::unique_ptr<T>::get()->operator[](arg);
 			}
 
+			//maps have no const operator[]: missing key reads as default value, like Value's const operator[]
 			template<typename U>
 			decltype(auto) operator[](const U& arg) const {
-				return std::unique_ptr<T>::get()->operator[](arg);
+				const T& object = *std::unique_ptr<T>::get();
+				if constexpr (is_map<T>::value) {
+					static const typename T::mapped_type missing{};
+					auto it = object.find(arg);
+					return it != object.end() ? it->second : missing;
+				} else {
+					return object[arg];
+				}
 			}
 
 			bool operator==(const HeapObject& right) const {
@@ -147,21 +173,51 @@ namespace JSON {
 	using JString = _helpers::HeapObject<std::string>;
 	using JObject = _helpers::HeapObject<std::unordered_map<std::string, JValue>>;
 	using JArray = _helpers::HeapObject<std::vector<JValue>>;
+	//homogeneous numeric arrays, parser makes them only with packNumbers policy
+	using JIntArray = _helpers::HeapObject<std::vector<int64_t>>;
+	using JDoubleArray = _helpers::HeapObject<std::vector<double>>;
 	struct JNumber {};
 	using JBool= _helpers::HeapObject<bool>;
 	using JEmpty = std::nullptr_t;
 
+	//read-only view of packed array's numbers, std::span isn't available in C++17
+	template<typename T>
+	class NumberSpan {
+		const T* _data{ nullptr };
+		size_t _size{ 0 };
+	public:
+		NumberSpan() = default;
+		NumberSpan(const T* data, size_t size) : _data{ data }, _size{ size } {}
+
+		const T* data() const { return _data; }
+		size_t size() const { return _size; }
+		bool empty() const { return _size == 0; }
+		const T* begin() const { return _data; }
+		const T* end() const { return _data + _size; }
+		const T& operator[](size_t index) const { return _data[index]; }
+	};
+
     class Value {	
     private:
 		using JInt = _helpers::HeapObject<int64_t>;
 		using JDouble = _helpers::HeapObject<double>;
-		using Data = std::variant<JEmpty, JObject, JArray, JString, JInt, JDouble, JBool>;
+		using Data = std::variant<JEmpty, JObject, JArray, JString, JInt, JDouble, JBool, JIntArray, JDoubleArray>;
 		Data _data;
 		
 	public:
 
 		template<typename T>
-		inline bool is() const { return std::holds_alternative<T>(_data); }
+		inline bool is() const {
+			if constexpr (std::is_same_v<T, JNumber>) {
+				return std::holds_alternative<JInt>(_data) || std::holds_alternative<JDouble>(_data);
+			} else if constexpr (std::is_integral_v<T> && !std::is_same_v<T, bool>) {
+				return std::holds_alternative<JInt>(_data);
+			} else if constexpr (std::is_floating_point_v<T>) {
+				return std::holds_alternative<JDouble>(_data);
+			} else {
+				return std::holds_alternative<T>(_data);
+			}
+		}
 
 		Value() = default;
 
@@ -180,11 +236,26 @@ namespace JSON {
 		bool operator==(const Value& right) const;
 		bool operator!=(const Value& right) const;
 
+		inline bool isPacked() const {
+			return is<JIntArray>() || is<JDoubleArray>();
+		}
+		//turns packed array into general JArray, does nothing with other values
+		void unpack();
+		//numbers of JIntArray (T = int64_t) or JDoubleArray (T = double), empty span for everything else
+		template<typename T>
+		NumberSpan<T> getNumbers() const;
+		//element of packed or general array converted like getAs<T>(), packed array stays packed;
+		//throws std::out_of_range for bad index and std::bad_variant_access if value or element isn't number
+		template<typename T = double>
+		T numberAt(size_t index) const;
+
 		bool hasKey(const std::string& right) const;
 		JValue& operator[](const std::string& right);
+		//returned element can be changed, so packed array is unpacked first; read it with numberAt() instead
 		JValue& operator[](const size_t right);
 
 		const JValue& operator[](const std::string& right) const;
+		//packed array has no JValue elements: throws std::bad_variant_access, use numberAt()
 		const JValue& operator[](const size_t right) const;
        
 		template<typename T>
@@ -266,6 +337,10 @@ namespace JSON {
 			return std::get<JString>(_data).value();
 		} else if constexpr (std::is_same_v<decayed_t, bool>) {
 			return std::get<JBool>(_data).value();
+		} else if constexpr (std::is_same_v<decayed_t, JArray>) {
+			//packed array becomes general one as soon as it can be changed through JArray
+			unpack();
+			return std::get<JArray>(_data);
 		} else {
 			return std::get<decayed_t>(_data);
 		}	
@@ -297,6 +372,28 @@ namespace JSON {
 		}
 	}
 
+	template<typename T>
+	NumberSpan<T> Value::getNumbers() const {
+		static_assert(std::is_same_v<T, int64_t> || std::is_same_v<T, double>, "packed arrays hold int64_t or double");
+		using packed_t = std::conditional_t<std::is_same_v<T, int64_t>, JIntArray, JDoubleArray>;
+		if (auto packed = std::get_if<packed_t>(&_data)) {
+			return NumberSpan<T>((*packed)->data(), (*packed)->size());
+		}
+		return NumberSpan<T>();
+	}
+
+	template<typename T>
+	T Value::numberAt(size_t index) const {
+		if (auto ints = std::get_if<JIntArray>(&_data)) {
+			return static_cast<T>((*ints)->at(index));
+		}
+		if (auto doubles = std::get_if<JDoubleArray>(&_data)) {
+			return static_cast<T>((*doubles)->at(index));
+		}
+		const Value& item = *std::get<JArray>(_data)->at(index);
+		return item.getAs<T>();
+	}
+
 	template<typename T, typename... Types>
 	auto& Value::emplace(Types&&... args) {
 		if constexpr (std::is_same_v<std::decay_t<T>, JNumber>) {
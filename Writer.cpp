@@ -0,0 +1,269 @@
+//
+//  infyJSON lib
+//
+
+#include "Writer.h"
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+namespace JSON {
+
+	namespace {
+
+		//containers with fewer elements are rendered as one piece
+		constexpr size_t minSplitElements = 256;
+		constexpr int maxSplitDepth = 2;
+
+		//"%f" is what std::to_string uses, so output matches Value::write()
+		size_t formatDouble(double number, char* buffer, size_t size) {
+			return static_cast<size_t>(std::snprintf(buffer, size, "%f", number));
+		}
+
+		size_t measureDigits(uint64_t number) {
+			size_t result = 1;
+			while (number >= 10) {
+				number /= 10;
+				++result;
+			}
+			return result;
+		}
+
+		size_t measureInt(int64_t number) {
+			return (number < 0 ? 1 : 0) + measureDigits(number < 0 ? 0 - static_cast<uint64_t>(number) : static_cast<uint64_t>(number));
+		}
+
+		//"%f" prints sign, integer part and 6 decimals, so only rounding carry into integer part needs care;
+		//values which are too close to carry boundary or too big are formatted for real
+		size_t measureDouble(double number) {
+			double magnitude = std::fabs(number);
+			if (std::isfinite(number) && magnitude < 1e15) {
+				auto integer = static_cast<uint64_t>(magnitude);
+				double fraction = magnitude - static_cast<double>(integer);
+				if (std::fabs(fraction - 0.9999995) > 1e-9) {
+					return (std::signbit(number) ? 1 : 0) + measureDigits(integer + (fraction > 0.9999995 ? 1 : 0)) + 7;
+				}
+			}
+			return formatDouble(number, nullptr, 0);
+		}
+
+		template<typename T>
+		size_t measureNumbers(NumberSpan<T> numbers) {
+			size_t result = 2 + (numbers.empty() ? 0 : numbers.size() - 1);
+			for (T number : numbers) {
+				if constexpr (std::is_same_v<T, int64_t>) {
+					result += measureInt(number);
+				} else {
+					result += measureDouble(number);
+				}
+			}
+			return result;
+		}
+
+		template<typename T>
+		char* renderNumbers(NumberSpan<T> numbers, char* out) {
+			*out++ = '[';
+			bool first = true;
+			for (T number : numbers) {
+				if (!first) *out++ = ',';
+				first = false;
+				if constexpr (std::is_same_v<T, int64_t>) {
+					out = std::to_chars(out, out + 20, number).ptr;
+				} else {
+					char buffer[512];
+					size_t size = formatDouble(number, buffer, sizeof(buffer));
+					std::memcpy(out, buffer, size);
+					out += size;
+				}
+			}
+			*out++ = ']';
+			return out;
+		}
+
+		char* render(const Value& value, char* out) {
+			if (value.is<JEmpty>()) {
+				std::memcpy(out, "null", 4);
+				return out + 4;
+			}
+			if (value.is<JBool>()) {
+				bool b = value.getAs<bool>();
+				std::memcpy(out, b ? "true" : "false", b ? 4 : 5);
+				return out + (b ? 4 : 5);
+			}
+			if (value.is<int64_t>()) {
+				return std::to_chars(out, out + 20, value.getAs<int64_t>()).ptr;
+			}
+			if (value.is<double>()) {
+				char buffer[512];
+				size_t size = formatDouble(value.getAs<double>(), buffer, sizeof(buffer));
+				std::memcpy(out, buffer, size);
+				return out + size;
+			}
+			if (value.is<JString>()) {
+				const auto& str = value.getAs<std::string>();
+				*out++ = '\"';
+				std::memcpy(out, str.data(), str.size());
+				out += str.size();
+				*out++ = '\"';
+				return out;
+			}
+			if (value.is<JArray>()) {
+				*out++ = '[';
+				bool first = true;
+				for (const auto& item : value.getAs<JArray>().value()) {
+					if (!first) *out++ = ',';
+					first = false;
+					out = render(item.value(), out);
+				}
+				*out++ = ']';
+				return out;
+			}
+			if (value.is<JIntArray>()) return renderNumbers(value.getNumbers<int64_t>(), out);
+			if (value.is<JDoubleArray>()) return renderNumbers(value.getNumbers<double>(), out);
+			*out++ = '{';
+			bool first = true;
+			for (const auto& [key, item] : value.getAs<JObject>().value()) {
+				if (!first) *out++ = ',';
+				first = false;
+				*out++ = '\"';
+				std::memcpy(out, key.data(), key.size());
+				out += key.size();
+				*out++ = '\"';
+				*out++ = ':';
+				out = render(item.value(), out);
+			}
+			*out++ = '}';
+			return out;
+		}
+
+		//text in front of value (brackets, commas, keys) plus the value itself, or closing bracket when value is null
+		struct Piece {
+			std::string prefix;
+			const Value* value;
+			size_t size{ 0 };
+			size_t offset{ 0 };
+		};
+
+		bool isBig(const Value& value) {
+			return (value.is<JArray>() && value.getAs<JArray>()->size() >= minSplitElements)
+				|| (value.is<JObject>() && value.getAs<JObject>()->size() >= minSplitElements);
+		}
+
+		//cuts big containers into pieces, everything else becomes a single piece
+		void cut(const Value& value, std::string prefix, int depth, std::vector<Piece>& pieces) {
+			bool isArray = value.is<JArray>();
+			if (depth > 0 && (depth >= maxSplitDepth || !isBig(value))) {
+				pieces.push_back({ std::move(prefix), &value });
+				return;
+			}
+			if (!isArray && !value.is<JObject>()) {
+				pieces.push_back({ std::move(prefix), &value });
+				return;
+			}
+			prefix += isArray ? '[' : '{';
+			bool first = true;
+			if (isArray) {
+				for (const auto& item : value.getAs<JArray>().value()) {
+					if (!first) prefix += ',';
+					first = false;
+					cut(item.value(), std::move(prefix), depth + 1, pieces);
+					prefix.clear();
+				}
+			} else {
+				for (const auto& [key, item] : value.getAs<JObject>().value()) {
+					if (!first) prefix += ',';
+					first = false;
+					prefix += '\"';
+					prefix += key;
+					prefix += "\":";
+					cut(item.value(), std::move(prefix), depth + 1, pieces);
+					prefix.clear();
+				}
+			}
+			prefix += isArray ? ']' : '}';
+			pieces.push_back({ std::move(prefix), nullptr });
+		}
+
+		template<typename Function>
+		void parallelFor(size_t count, unsigned threads, Function&& function) {
+			constexpr size_t batch = 64;
+			std::atomic<size_t> next{ 0 };
+			auto worker = [&]() {
+				for (size_t begin = next.fetch_add(batch); begin < count; begin = next.fetch_add(batch)) {
+					for (size_t i = begin; i < std::min(begin + batch, count); ++i) {
+						function(i);
+					}
+				}
+			};
+			std::vector<std::thread> pool;
+			unsigned poolSize = static_cast<unsigned>(std::min<size_t>(threads, (count + batch - 1) / batch));
+			for (unsigned i = 1; i < poolSize; ++i) {
+				pool.emplace_back(worker);
+			}
+			worker();
+			for (auto& thread : pool) {
+				thread.join();
+			}
+		}
+	}
+
+	size_t measure(const Value& value) {
+		if (value.is<JEmpty>()) return 4;
+		if (value.is<JBool>()) return value.getAs<bool>() ? 4 : 5;
+		if (value.is<int64_t>()) return measureInt(value.getAs<int64_t>());
+		if (value.is<double>()) return measureDouble(value.getAs<double>());
+		if (value.is<JString>()) return value.getAs<std::string>().size() + 2;
+		if (value.is<JIntArray>()) return measureNumbers(value.getNumbers<int64_t>());
+		if (value.is<JDoubleArray>()) return measureNumbers(value.getNumbers<double>());
+		size_t result = 2;
+		if (value.is<JArray>()) {
+			const auto& arr = value.getAs<JArray>().value();
+			result += arr.empty() ? 0 : arr.size() - 1;
+			for (const auto& item : arr) {
+				result += measure(item.value());
+			}
+		} else {
+			const auto& map = value.getAs<JObject>().value();
+			result += map.empty() ? 0 : map.size() - 1;
+			for (const auto& [key, item] : map) {
+				result += key.size() + 3 + measure(item.value());
+			}
+		}
+		return result;
+	}
+
+	std::string write(const Value& value, unsigned threads) {
+		if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+		if (threads == 1 || !isBig(value)) {
+			std::string result(measure(value), '\0');
+			render(value, result.data());
+			return result;
+		}
+
+		std::vector<Piece> pieces;
+		cut(value, std::string(), 0, pieces);
+		parallelFor(pieces.size(), threads, [&pieces](size_t i) {
+			pieces[i].size = pieces[i].prefix.size() + (pieces[i].value ? measure(*pieces[i].value) : 0);
+		});
+		size_t total = 0;
+		for (auto& piece : pieces) {
+			piece.offset = total;
+			total += piece.size;
+		}
+
+		std::string result(total, '\0');
+		char* out = result.data();
+		parallelFor(pieces.size(), threads, [&pieces, out](size_t i) {
+			const auto& piece = pieces[i];
+			std::memcpy(out + piece.offset, piece.prefix.data(), piece.prefix.size());
+			if (piece.value) {
+				render(*piece.value, out + piece.offset + piece.prefix.size());
+			}
+		});
+		return result;
+	}
+}
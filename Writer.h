@@ -0,0 +1,17 @@
+//
+//  infyJSON lib
+//
+#pragma once
+
+#include "Value.h"
+
+namespace JSON {
+
+	//exact number of bytes Value::write() produces for value
+	size_t measure(const Value& value);
+
+	//Same output as Value::write(), but output is allocated once with exact size.
+	//With threads > 1 big arrays and objects are cut into pieces which are measured and then
+	//rendered in parallel, each straight into its final place. threads == 0 means std::thread::hardware_concurrency().
+	std::string write(const Value& value, unsigned threads = 1);
+}
@@ -0,0 +1,111 @@
+//
+//  infyJSON lib
+//
+//  Regression tests for Binary.h, build them together with the library sources:
+//  g++ -std=c++17 -I.. BinaryTests.cpp ../*.cpp && ./a.out
+
+#include "Binary.h"
+#include "Parser.h"
+#include <cstdio>
+#include <string>
+
+using namespace JSON;
+
+namespace {
+	int failures = 0;
+
+	void check(bool ok, const char* what) {
+		if (!ok) {
+			std::printf("FAILED: %s\n", what);
+			++failures;
+		}
+	}
+
+	//every width of every tag survives the round trip and keeps int/double apart
+	void roundTrip() {
+		std::string text = R"({"small":[0,127,-32,-1,128,-33,255,-129,32767,-32768,65536,-2147483648,2147483648,-9223372036854775807],)"
+			R"("doubles":[0.5,-0.0,0.1,1e300,-3.4028234663852886e38,1.0],"flags":[true,false,null],"empty":{},"none":[],)"
+			R"("repeated":["a","a","b","b","b"],"unique":"only once","long":")" + std::string(70000, 'x') + R"("})";
+		auto value = parseFromString(text);
+		check(value.has_value(), "document parsed");
+		if (!value) return;
+		auto restored = fromBinary(toBinary(*value));
+		check(restored && *restored == *value, "round trip is equal");
+		if (!restored) return;
+		check((*restored)["doubles"][5]->is<double>(), "1.0 stays double");
+		check((*restored)["small"][13]->getAs<int64_t>() == -9223372036854775807, "int64 kept");
+		check((*restored)["doubles"][2]->getAs<double>() == 0.1, "double which isn't exact float kept");
+	}
+
+	//containers larger than 15 entries and 255/65535 bytes take the wider headers
+	void largeContainers() {
+		Value arr;
+		for (int i = 0; i < 70000; ++i) {
+			arr[static_cast<size_t>(i)].value().emplace<JNumber>(i * 7);
+		}
+		Value obj;
+		for (int i = 0; i < 300; ++i) {
+			obj["key" + std::to_string(i)].value().emplace<JString>(std::string(i % 40, 'v'));
+		}
+		Value doc;
+		doc["arr"] = JValue{ arr };
+		doc["obj"] = JValue{ obj };
+		auto snapshot = toBinary(doc);
+		auto restored = fromBinary(snapshot);
+		check(restored && *restored == doc, "large containers round trip");
+		auto view = BinaryView::open(snapshot);
+		check(view && (*view)["arr"].size() == 70000 && (*view)["arr"][69999].getInt() == 69999 * 7, "view reads wide array");
+		check(view && (*view)["obj"]["key299"].getString().size() == 299 % 40, "view reads wide object");
+		size_t entries = 0;
+		if (view) {
+			for (const auto& entry : (*view)["obj"]) {
+				entries += entry.value.is<JString>() ? 1 : 0;
+			}
+		}
+		check(entries == 300, "iterator visits every entry");
+	}
+
+	//packed arrays are written as ordinary arrays of compact numbers
+	void packedArrays() {
+		auto packed = parseFromString<PackedPolicy>(std::string("[[1,2,300,-5],[0.5,2.25]]"));
+		check(packed && (*packed)[0].value().isPacked(), "arrays are packed");
+		if (!packed) return;
+		auto restored = fromBinary(toBinary(*packed));
+		check(restored && *restored == *packed, "packed arrays round trip");
+	}
+
+	//no prefix or damaged byte of a snapshot may read out of bounds
+	void brokenInput() {
+		auto value = parseFromString(R"({"a":[1,"bb",{"c":null}],"d":"bb","e":1.5})");
+		auto snapshot = toBinary(*value);
+		for (size_t size = 0; size < snapshot.size(); ++size) {
+			check(!fromBinary(std::string_view(snapshot.data(), size)), "truncated snapshot rejected");
+			if (auto view = BinaryView::open(std::string_view(snapshot.data(), size))) {
+				view->toValue();
+				for (const auto& entry : *view) {
+					entry.value.toValue();
+				}
+			}
+		}
+		for (size_t i = 0; i < snapshot.size(); ++i) {
+			for (int bits : { 0x01, 0x10, 0x80, 0xFF }) {
+				std::string damaged = snapshot;
+				damaged[i] = static_cast<char>(damaged[i] ^ bits);
+				fromBinary(damaged);
+				if (auto view = BinaryView::open(damaged)) {
+					view->toValue();
+					(*view)["a"][1].is<JString>();
+				}
+			}
+		}
+	}
+}
+
+int main() {
+	roundTrip();
+	largeContainers();
+	packedArrays();
+	brokenInput();
+	std::printf("%d failed\n", failures);
+	return failures != 0;
+}
@@ -0,0 +1,67 @@
+//
+//  infyJSON lib
+//
+//  Regression tests for Binding.h, build them together with the library sources:
+//  g++ -std=c++17 -I.. BindingTests.cpp ../*.cpp && ./a.out
+
+#include "Binding.h"
+#include <cstdio>
+#include <limits>
+
+namespace {
+	struct Record {
+		std::string name;
+		double ratio;
+		float scale;
+		std::map<std::string, int> counts;
+	};
+}
+
+template<>
+struct JSON::Fields<Record> {
+	static constexpr auto list = std::make_tuple(INFYJSON_FIELD(Record, name), INFYJSON_FIELD(Record, ratio),
+		INFYJSON_FIELD(Record, scale), INFYJSON_FIELD(Record, counts));
+};
+
+namespace {
+	int failures = 0;
+
+	void check(bool ok, const char* what) {
+		if (!ok) {
+			std::printf("FAILED: %s\n", what);
+			++failures;
+		}
+	}
+
+	void stringsAreEscapedAndDecoded() {
+		Record record{ "He said \"hi\"\n\\\t\x01", 0, 0, { { "a\"b", 1 } } };
+		auto text = JSON::serialize(record);
+		auto back = JSON::parseAs<Record>(text);
+		check(back && back->name == record.name && back->counts == record.counts, "escaped string round trip");
+		auto unicode = JSON::parseAs<Record>(R"({"name":"é€😀\/"})");
+		check(unicode && unicode->name == "\xc3\xa9\xe2\x82\xac\xf0\x9f\x98\x80/", "unicode escapes decoded");
+		check(!JSON::parseAs<Record>(R"({"name":"\ud83d"})"), "lone surrogate rejected");
+		check(!JSON::parseAs<Record>(R"({"name":"\q"})"), "unknown escape rejected");
+	}
+
+	void numbersRoundTrip() {
+		Record record{ "", 1e-9, 0.1f, {} };
+		auto back = JSON::parseAs<Record>(JSON::serialize(record));
+		check(back && back->ratio == record.ratio && back->scale == record.scale, "floating point round trip");
+		bool thrown = false;
+		try {
+			record.ratio = std::numeric_limits<double>::quiet_NaN();
+			JSON::serialize(record);
+		} catch (const std::domain_error&) {
+			thrown = true;
+		}
+		check(thrown, "NaN rejected");
+	}
+}
+
+int main() {
+	stringsAreEscapedAndDecoded();
+	numbersRoundTrip();
+	std::printf("%d failed\n", failures);
+	return failures == 0 ? 0 : 1;
+}
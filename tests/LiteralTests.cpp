@@ -0,0 +1,48 @@
+//
+//  infyJSON lib
+//
+//  Regression tests for Literal.h, build them together with the library sources:
+//  g++ -std=c++17 -I.. LiteralTests.cpp ../*.cpp && ./a.out
+
+#include "Literal.h"
+#include <cstdio>
+
+using namespace JSON;
+
+static_assert(literals::isValid(R"(["a\n\"", "\/", "\u00E9"])"));
+static_assert(!literals::isValid(R"(["\q"])"), "unknown escape is malformed");
+static_assert(!literals::isValid(R"(["\u12"])"), "short \\u escape is malformed");
+
+namespace {
+	int failures = 0;
+
+	void check(bool ok, const char* what) {
+		if (!ok) {
+			std::printf("FAILED: %s\n", what);
+			++failures;
+		}
+	}
+
+	void parsedOnce() {
+		const Value& first = INFYJSON_LITERAL(R"({"threads": 4})");
+		check(first["threads"]->getAs<int>() == 4, "literal parsed");
+	}
+
+	//out of range number passes compile-time check, runtime parser rejects it
+	void runtimeErrorThrows() {
+		bool thrown = false;
+		try {
+			INFYJSON_LITERAL("[99999999999999999999]");
+		} catch (const std::invalid_argument&) {
+			thrown = true;
+		}
+		check(thrown, "literal rejected by parser throws");
+	}
+}
+
+int main() {
+	parsedOnce();
+	runtimeErrorThrows();
+	std::printf("%d failed\n", failures);
+	return failures != 0;
+}
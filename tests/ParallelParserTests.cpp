@@ -0,0 +1,81 @@
+//
+//  infyJSON lib
+//
+//  Regression tests for ParallelParser.h, build them together with the library sources:
+//  g++ -std=c++17 -pthread -I.. ParallelParserTests.cpp ../*.cpp && ./a.out
+
+#include "ParallelParser.h"
+#include "Parser.h"
+#include <cstdio>
+#include <string>
+
+using namespace JSON;
+
+namespace {
+	int failures = 0;
+
+	void check(bool ok, const char* what) {
+		if (!ok) {
+			std::printf("FAILED: %s\n", what);
+			++failures;
+		}
+	}
+
+	//big enough to be split between threads
+	std::string bigArray(size_t count) {
+		std::string text = "[";
+		for (size_t i = 0; i < count; ++i) {
+			text += std::to_string(i * 31) + (i + 1 < count ? "," : "]");
+		}
+		return text;
+	}
+
+	//value of duplicate key is dropped, but it still has to be valid
+	void duplicateKeyIsValidated() {
+		std::string array = bigArray(300000);
+		auto good = parseFromStringParallel(R"({"a":)" + array + R"(,"a":true})", 4);
+		check(good && (*good)["a"]->is<JArray>(), "first duplicate wins");
+		check(!parseFromStringParallel(R"({"a":)" + array + R"(,"a":tru})", 4), "broken duplicate value rejected");
+		check(!parseFromStringParallel(R"({"a":)" + array + R"(,"b":1,"b":[1,2,]})", 4), "broken duplicate container rejected");
+	}
+
+	//elements parsed on workers end up in their places
+	void matchesSequentialParser() {
+		std::string text = R"({"ints":)" + bigArray(400000) + R"(,"objects":[)";
+		for (int i = 0; i < 50000; ++i) {
+			text += R"({"id":)" + std::to_string(i) + R"(,"name":"n)" + std::to_string(i) + R"("},)";
+		}
+		text += "null]}";
+		auto parallel = parseFromStringParallel(text, 4);
+		auto sequential = parseFromString(text);
+		check(parallel && sequential && *parallel == *sequential, "parallel result equals sequential");
+	}
+
+	//error inside a run of elements is reported like sequential parser does
+	void errorMatchesSequentialParser() {
+		for (const char* broken : { "tru", R"({"x":[1,nul]})" }) {
+			std::string text = R"({"list":)" + bigArray(300000);
+			text.insert(text.find(',', text.size() * 7 / 10) + 1, std::string(broken) + ",");
+			text += "}";
+			check(!parseFromString(text), "sequential parser fails");
+			ParseError expected = getLastError();
+			check(!parseFromStringParallel(text, 4), "parallel parser fails");
+			ParseError error = getLastError();
+			check(error.code == expected.code && error.offset == expected.offset && error.path == expected.path, "same error as sequential parser");
+		}
+	}
+
+	void missingFileSetsError() {
+		check(!parseFromFileParallel("no/such/file.json", 4), "missing file fails");
+		check(getLastError().code == ErrorCode::FILE_ERROR, "missing file sets FILE_ERROR");
+	}
+}
+
+int main() {
+	duplicateKeyIsValidated();
+	matchesSequentialParser();
+	errorMatchesSequentialParser();
+	missingFileSetsError();
+	std::printf("%d failed\n", failures);
+	return failures != 0;
+}
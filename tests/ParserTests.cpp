@@ -0,0 +1,40 @@
+//
+//  infyJSON lib
+//
+//  Regression tests for Parser.h, build them together with the library sources:
+//  g++ -std=c++17 -I.. ParserTests.cpp ../*.cpp && ./a.out
+
+#include "Parser.h"
+#include <cstdio>
+#include <string>
+
+using namespace JSON;
+
+namespace {
+	int failures = 0;
+
+	void check(bool ok, const char* what) {
+		if (!ok) {
+			std::printf("FAILED: %s\n", what);
+			++failures;
+		}
+	}
+
+	//numbers which don't fit the target type are errors, not zeros
+	template<typename Policy>
+	void outOfRangeNumbers() {
+		for (const char* text : { "[99999999999999999999]", "[1,-99999999999999999999]", "[1e400]", "[0.5,-1e999]" }) {
+			check(!parseFromString<Policy>(std::string(text)), "out of range number rejected");
+			check(getLastError().code == ErrorCode::INVALID_NUMBER, "out of range number reported as INVALID_NUMBER");
+		}
+		auto limits = parseFromString<Policy>(std::string("[9223372036854775807,-9223372036854775808]"));
+		check(limits && *limits == *parseFromString("[9223372036854775807,-9223372036854775808]"), "int64_t limits accepted");
+	}
+}
+
+int main() {
+	outOfRangeNumbers<DefaultPolicy>();
+	outOfRangeNumbers<PackedPolicy>();
+	std::printf("%d failed\n", failures);
+	return failures != 0;
+}
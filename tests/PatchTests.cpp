@@ -0,0 +1,55 @@
+//
+//  infyJSON lib
+//
+//  Regression tests for Patch.h, build them together with the library sources:
+//  g++ -std=c++17 -I.. PatchTests.cpp ../*.cpp && ./a.out
+
+#include "Patch.h"
+#include "Parser.h"
+#include <cstdio>
+
+using namespace JSON;
+
+namespace {
+	int failures = 0;
+
+	void check(bool ok, const char* what) {
+		if (!ok) {
+			std::printf("FAILED: %s\n", what);
+			++failures;
+		}
+	}
+
+	//child changed through a reference taken before hashing must still show up in diffs
+	void diffSeesChangesThroughOldReferences() {
+		Value old = *parseFromString(R"({"a":{"b":1},"c":[1,2]})");
+		Value doc = old;
+		auto& a = doc["a"].value();
+		HashCache hashes;
+		check(hashes.equal(old, doc), "copy is equal");
+		check(hash(old) == hash(doc), "copy has equal hash");
+		a["b"].value() = Value(2);
+		check(diff(old, doc).getAs<JArray>()->size() == 1, "diff after change through old reference");
+		check(mergeDiff(old, doc).getAs<JObject>()->size() == 1, "merge diff after change through old reference");
+		hashes.clear();
+		check(!hashes.equal(old, doc), "cleared cache sees change");
+		check(applyPatch(old, diff(old, doc)) && old == doc, "diff applied");
+	}
+
+	//RFC 6902 4.6: 1 and 1.0 are the same number
+	void testComparesNumbersByValue() {
+		Value doc = *parseFromString(R"({"a":1,"b":[1,2.5,{"c":3}]})");
+		check(applyPatch(doc, *parseFromString(R"([{"op":"test","path":"/a","value":1.0}])")), "test 1 against 1.0");
+		check(applyPatch(doc, *parseFromString(R"([{"op":"test","path":"/b","value":[1.0,2.5,{"c":3.0}]}])")), "test nested numbers");
+		check(!applyPatch(doc, *parseFromString(R"([{"op":"test","path":"/a","value":1.5}])")), "test different number");
+		Value packed = *parseFromString<PackedPolicy>(R"({"a":[1,2,3]})");
+		check(applyPatch(packed, *parseFromString(R"([{"op":"test","path":"/a","value":[1.0,2,3]}])")), "test packed array");
+	}
+}
+
+int main() {
+	diffSeesChangesThroughOldReferences();
+	testComparesNumbersByValue();
+	std::printf("%d failed\n", failures);
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,79 @@
+//
+//  infyJSON lib
+//
+//  Regression tests for Schema.h, build them together with the library sources:
+//  g++ -std=c++17 -I.. SchemaTests.cpp ../*.cpp && ./a.out
+
+#include "Schema.h"
+#include "Parser.h"
+#include <cstdio>
+#include <string>
+
+using namespace JSON;
+
+namespace {
+	int failures = 0;
+
+	void check(bool ok, const char* what) {
+		if (!ok) {
+			std::printf("FAILED: %s\n", what);
+			++failures;
+		}
+	}
+
+	std::optional<Schema> compile(const char* text) {
+		auto schema = parseFromString(text);
+		return schema ? Schema::compile(*schema) : std::nullopt;
+	}
+
+	//pattern matching must not recurse per character of the input
+	void longStringMatchesPattern() {
+		auto schema = compile(R"({"type":"string","pattern":"^(a|b)*$"})");
+		check(schema.has_value(), "pattern schema compiles");
+		if (!schema) return;
+		std::string doc = "\"" + std::string(200000, 'a') + "\"";
+		check(parseFromString(doc, *schema).has_value(), "200KB string matches");
+		doc[100000] = 'c';
+		check(!parseFromString(doc, *schema).has_value(), "200KB string with wrong char fails");
+	}
+
+	//patterns aren't anchored unless they say so
+	void patternIsSearched() {
+		auto schema = compile(R"({"type":"string","pattern":"b+c"})");
+		if (!schema) return check(false, "unanchored schema compiles");
+		check(parseFromString(R"("aabbcdd")", *schema).has_value(), "match in the middle");
+		check(!parseFromString(R"("aacdd")", *schema).has_value(), "no match");
+		check(!compile(R"({"pattern":"a)(b"})").has_value(), "unbalanced pattern is rejected");
+	}
+
+	//enum and pointers into packed arrays
+	void packedEnum() {
+		auto value = parseFromString<PackedPolicy>(std::string(R"({"enum":[1,2,3]})"));
+		check(value && (*value)["enum"].value().isPacked(), "enum is packed");
+		if (!value) return;
+		auto schema = Schema::compile(*value);
+		check(schema.has_value(), "packed enum compiles");
+		if (!schema) return;
+		check(schema->validate(*parseFromString("2")), "enum value accepted");
+		check(!schema->validate(*parseFromString("4")), "other value rejected");
+		auto ref = parseFromString<PackedPolicy>(std::string(R"({"enum":[1,2],"items":{"$ref":"#/enum/0"}})"));
+		check(ref && !Schema::compile(*ref).has_value(), "$ref to packed number is rejected");
+	}
+
+	//schema is installed for one parse only
+	void schemaIsScopedToParse() {
+		auto schema = compile(R"({"type":"object"})");
+		if (!schema) return check(false, "object schema compiles");
+		check(!parseFromString("[1]", *schema).has_value(), "array rejected by schema");
+		check(parseFromString("[1]").has_value(), "array accepted without schema");
+	}
+}
+
+int main() {
+	longStringMatchesPattern();
+	patternIsSearched();
+	packedEnum();
+	schemaIsScopedToParse();
+	std::printf("%d failed\n", failures);
+	return failures != 0;
+}
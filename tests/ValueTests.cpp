@@ -0,0 +1,52 @@
+//
+//  infyJSON lib
+//
+//  Regression tests for Value.h, build them together with the library sources:
+//  g++ -std=c++17 -I.. ValueTests.cpp ../*.cpp && ./a.out
+
+#include "Parser.h"
+#include <cstdio>
+
+using namespace JSON;
+
+namespace {
+	int failures = 0;
+
+	void check(bool ok, const char* what) {
+		if (!ok) {
+			std::printf("FAILED: %s\n", what);
+			++failures;
+		}
+	}
+
+	//usage example from README reads objects through const references
+	void readThroughConstObject() {
+		auto json = parseFromString(R"([{"name":"infy","number":17,"is_cool":true}])");
+		check(json && json->is<JArray>(), "array parsed");
+		if (!json) return;
+		for (const auto& val : json->getAs<JArray>().value()) {
+			check(val->is<JObject>(), "element is object");
+			auto& object = val->getAs<JObject>();
+			check(object["name"]->getAs<JString>().value() == "infy", "string read");
+			check(object["number"]->getAs<JNumber>() == 17, "number read");
+			check(object["is_cool"]->getAs<JBool>().value(), "bool read");
+			check(object["missing"]->is<JEmpty>(), "missing key reads as null");
+			check(object->size() == 3, "missing key isn't inserted");
+		}
+	}
+
+	//packed arrays are read without unpacking
+	void readPackedThroughConst() {
+		const Value value = *parseFromString<PackedPolicy>(std::string("[1,2,3]"));
+		check(value.isPacked(), "array is packed");
+		check(value.numberAt<int64_t>(1) == 2, "element read");
+		check(value.isPacked(), "array stays packed");
+	}
+}
+
+int main() {
+	readThroughConstObject();
+	readPackedThroughConst();
+	std::printf("%d failed\n", failures);
+	return failures != 0;
+}